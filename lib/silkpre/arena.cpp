@@ -0,0 +1,152 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "arena.h"
+
+#include <cstdlib>
+
+#include <silkpre/arena.hpp>
+
+namespace {
+
+constexpr size_t kDefaultBlockSize{64 * 1024};
+constexpr size_t kAlignment{16};
+
+struct alignas(kAlignment) Block {
+    Block* next;
+    size_t capacity;
+
+    uint8_t* data() noexcept { return reinterpret_cast<uint8_t*>(this + 1); }
+};
+
+Block* new_block(size_t capacity) noexcept {
+    auto* block{static_cast<Block*>(std::malloc(sizeof(Block) + capacity))};
+    if (block) {
+        *block = {nullptr, capacity};
+    }
+    return block;
+}
+
+void free_blocks(Block* block) noexcept {
+    while (block) {
+        Block* next{block->next};
+        std::free(block);
+        block = next;
+    }
+}
+
+thread_local SilkpreArena* current_arena{nullptr};
+
+}  // namespace
+
+struct SilkpreArena {
+    size_t block_size;
+    Block* blocks{nullptr};   // regular blocks, reused in order after a reset
+    Block* current{nullptr};  // block being filled
+    size_t offset{0};         // of the free space in current
+    Block* large{nullptr};    // dedicated blocks of outsized allocations, freed on reset
+    size_t used{0};
+};
+
+SilkpreArena* silkpre_arena_create(size_t block_size) {
+    const size_t size{block_size ? block_size : kDefaultBlockSize};
+    return new SilkpreArena{(size + kAlignment - 1) & ~(kAlignment - 1)};
+}
+
+void silkpre_arena_destroy(SilkpreArena* arena) {
+    free_blocks(arena->blocks);
+    free_blocks(arena->large);
+    delete arena;
+}
+
+void silkpre_arena_reset(SilkpreArena* arena) {
+    free_blocks(arena->large);
+    arena->large = nullptr;
+    arena->current = arena->blocks;
+    arena->offset = 0;
+    arena->used = 0;
+}
+
+void* silkpre_arena_alloc(SilkpreArena* arena, size_t size) {
+    // Size 0 still takes a slot, so that successful empty outputs are distinct non-null pointers
+    const size_t n{size ? (size + kAlignment - 1) & ~(kAlignment - 1) : kAlignment};
+    if (n < size) {
+        return nullptr;
+    }
+
+    // Anything over a quarter of a block would waste too much of it
+    if (n > arena->block_size / 4) {
+        Block* block{new_block(n)};
+        if (!block) {
+            return nullptr;
+        }
+        block->next = arena->large;
+        arena->large = block;
+        arena->used += n;
+        return block->data();
+    }
+
+    if (!arena->current || arena->offset + n > arena->current->capacity) {
+        Block* next{arena->current ? arena->current->next : arena->blocks};
+        if (!next) {
+            next = new_block(arena->block_size);
+            if (!next) {
+                return nullptr;
+            }
+            if (arena->current) {
+                arena->current->next = next;
+            } else {
+                arena->blocks = next;
+            }
+        }
+        arena->current = next;
+        arena->offset = 0;
+    }
+
+    uint8_t* p{arena->current->data() + arena->offset};
+    arena->offset += n;
+    arena->used += n;
+    return p;
+}
+
+size_t silkpre_arena_used(const SilkpreArena* arena) { return arena->used; }
+
+SilkpreOutput silkpre_arena_run(SilkpreArena* arena, SilkpreRunFunction run, const uint8_t* input, size_t len) {
+    silkpre::ArenaScope scope{arena};
+    return run(input, len);
+}
+
+SilkpreStatus silkpre_execute_arena(SilkpreArena* arena, const SilkpreContractDescriptor* contract,
+                                    const uint8_t* input, size_t len, int evmc_revision, uint64_t gas_limit,
+                                    uint64_t* gas_used, SilkpreOutput* output) {
+    silkpre::ArenaScope scope{arena};
+    return silkpre_execute(contract, input, len, evmc_revision, gas_limit, gas_used, output);
+}
+
+namespace silkpre {
+
+uint8_t* alloc_output(size_t size) noexcept {
+    if (current_arena) {
+        return static_cast<uint8_t*>(silkpre_arena_alloc(current_arena, size));
+    }
+    return static_cast<uint8_t*>(std::malloc(size));
+}
+
+ArenaScope::ArenaScope(SilkpreArena* arena) noexcept : previous_{current_arena} { current_arena = arena; }
+
+ArenaScope::~ArenaScope() { current_arena = previous_; }
+
+}  // namespace silkpre
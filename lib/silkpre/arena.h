@@ -0,0 +1,62 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_ARENA_H_
+#define SILKPRE_ARENA_H_
+
+// Bump allocation of precompile outputs, so that e.g. all calls of a block share a few
+// contiguous blocks of memory that are released with a single reset.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct SilkpreArena SilkpreArena;
+
+//! \brief Creates an arena growing by blocks of block_size bytes; 0 for the default of 64 KiB
+//! An arena is not thread-safe: each executor thread should have its own.
+SilkpreArena* silkpre_arena_create(size_t block_size);
+
+void silkpre_arena_destroy(SilkpreArena* arena);
+
+//! \brief Releases everything allocated from the arena at once, keeping its blocks for reuse
+void silkpre_arena_reset(SilkpreArena* arena);
+
+//! \brief Allocates size bytes aligned to 16 that live until the next reset
+//! \return Non-null, even for size 0, unless out of memory
+void* silkpre_arena_alloc(SilkpreArena* arena, size_t size);
+
+//! \brief Number of bytes allocated since the last reset, including alignment padding
+size_t silkpre_arena_used(const SilkpreArena* arena);
+
+//! \brief Same as run(input, len), but the output is allocated from the arena and must not be freed
+SilkpreOutput silkpre_arena_run(SilkpreArena* arena, SilkpreRunFunction run, const uint8_t* input, size_t len);
+
+//! \brief Same as silkpre_execute, but the output is allocated from the arena and must not be freed
+SilkpreStatus silkpre_execute_arena(SilkpreArena* arena, const SilkpreContractDescriptor* contract,
+                                    const uint8_t* input, size_t len, int evmc_revision, uint64_t gas_limit,
+                                    uint64_t* gas_used, SilkpreOutput* output);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_ARENA_H_
@@ -0,0 +1,46 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_ARENA_HPP_
+#define SILKPRE_ARENA_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/arena.h>
+
+namespace silkpre {
+
+// Allocates the output of a run function: from the arena of the enclosing
+// silkpre_arena_run on the calling thread, if any, and with malloc otherwise.
+uint8_t* alloc_output(size_t size) noexcept;
+
+// Routes alloc_output on the calling thread to the arena for the scope's lifetime
+class ArenaScope {
+  public:
+    explicit ArenaScope(SilkpreArena* arena) noexcept;
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+  private:
+    SilkpreArena* previous_;
+};
+
+}  // namespace silkpre
+
+#endif  // SILKPRE_ARENA_HPP_
@@ -0,0 +1,105 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "async.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+
+#include <silkpre/thread_pool.hpp>
+
+namespace {
+
+constexpr size_t kDefaultCapacity{1024};
+
+}  // namespace
+
+struct SilkpreQueue {
+    explicit SilkpreQueue(size_t c) : capacity{c} {}
+
+    const size_t capacity;
+    std::mutex mutex;
+    std::condition_variable completed;
+    std::deque<SilkpreCompletion> completions;
+    size_t running{0};    // submitted and not yet completed
+    size_t in_flight{0};  // submitted and not yet reaped
+};
+
+SilkpreQueue* silkpre_queue_create(size_t capacity) {
+    return new SilkpreQueue{capacity ? capacity : kDefaultCapacity};
+}
+
+void silkpre_queue_destroy(SilkpreQueue* queue) {
+    {
+        std::unique_lock lock{queue->mutex};
+        queue->completed.wait(lock, [queue] { return queue->running == 0; });
+    }
+    for (const SilkpreCompletion& c : queue->completions) {
+        std::free(c.output.data);
+    }
+    delete queue;
+}
+
+size_t silkpre_queue_submit(SilkpreQueue* queue, const SilkpreSubmission* submissions, size_t n) {
+    {
+        std::lock_guard lock{queue->mutex};
+        n = std::min(n, queue->capacity - queue->in_flight);
+        queue->in_flight += n;
+        queue->running += n;
+    }
+    silkpre::ThreadPool& pool{silkpre::ThreadPool::instance()};
+    for (size_t i{0}; i < n; ++i) {
+        pool.post([queue, s = submissions[i]] {
+            SilkpreCompletion c{s.user_data, SILKPRE_SUCCESS, 0, {nullptr, 0}};
+            c.status = silkpre_execute(s.contract, s.input, s.input_len, s.evmc_revision, s.gas_limit, &c.gas_used,
+                                       &c.output);
+            std::lock_guard lock{queue->mutex};
+            queue->completions.push_back(c);
+            --queue->running;
+            queue->completed.notify_all();
+        });
+    }
+    return n;
+}
+
+static size_t pop_completions(SilkpreQueue* queue, SilkpreCompletion* completions, size_t max) noexcept {
+    const size_t n{std::min(max, queue->completions.size())};
+    std::copy_n(queue->completions.begin(), n, completions);
+    queue->completions.erase(queue->completions.begin(), queue->completions.begin() + static_cast<ptrdiff_t>(n));
+    queue->in_flight -= n;
+    return n;
+}
+
+size_t silkpre_queue_reap(SilkpreQueue* queue, SilkpreCompletion* completions, size_t max) {
+    std::lock_guard lock{queue->mutex};
+    return pop_completions(queue, completions, max);
+}
+
+size_t silkpre_queue_wait(SilkpreQueue* queue, SilkpreCompletion* completions, size_t max, size_t min_complete) {
+    std::unique_lock lock{queue->mutex};
+    queue->completed.wait(lock, [queue, min_complete] {
+        return queue->completions.size() >= min_complete || queue->running == 0;
+    });
+    return pop_completions(queue, completions, max);
+}
+
+size_t silkpre_queue_in_flight(SilkpreQueue* queue) {
+    std::lock_guard lock{queue->mutex};
+    return queue->in_flight;
+}
@@ -0,0 +1,77 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_ASYNC_H_
+#define SILKPRE_ASYNC_H_
+
+// Asynchronous precompile calls through a submission/completion queue pair, io_uring style:
+// submitted calls run on the library's thread pool while the submitter carries on,
+// and their results are reaped from the completion queue later.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct SilkpreQueue SilkpreQueue;
+
+typedef struct SilkpreSubmission {
+    uint64_t user_data;  // handed back in the completion
+    const SilkpreContractDescriptor* contract;
+    const uint8_t* input;  // has to stay valid until the completion is reaped
+    size_t input_len;
+    int evmc_revision;
+    uint64_t gas_limit;
+} SilkpreSubmission;
+
+typedef struct SilkpreCompletion {
+    uint64_t user_data;
+    SilkpreStatus status;
+    uint64_t gas_used;
+    SilkpreOutput output;  // set on success only and has to be freed then
+} SilkpreCompletion;
+
+//! \brief Creates a queue pair
+//! \param [in] capacity : maximum number of calls submitted and not yet reaped; 0 for the default of 1024
+SilkpreQueue* silkpre_queue_create(size_t capacity);
+
+//! \brief Waits for the calls in flight, then frees the queue along with the outputs that weren't reaped
+void silkpre_queue_destroy(SilkpreQueue* queue);
+
+//! \brief Submits calls in order until the queue is full
+//! \return Number of calls accepted
+size_t silkpre_queue_submit(SilkpreQueue* queue, const SilkpreSubmission* submissions, size_t n);
+
+//! \brief Moves up to max completions, in order of completion, out of the queue without blocking
+//! \return Number of completions reaped
+size_t silkpre_queue_reap(SilkpreQueue* queue, SilkpreCompletion* completions, size_t max);
+
+//! \brief Same as silkpre_queue_reap, but first waits for at least min_complete completions
+//! or for all calls in flight to complete, whichever comes first
+size_t silkpre_queue_wait(SilkpreQueue* queue, SilkpreCompletion* completions, size_t max, size_t min_complete);
+
+//! \brief Number of calls submitted and not yet reaped
+size_t silkpre_queue_in_flight(SilkpreQueue* queue);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_ASYNC_H_
@@ -0,0 +1,79 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_ASYNC_HPP_
+#define SILKPRE_ASYNC_HPP_
+
+// C++20 coroutine front end of async.h:
+//
+//     SilkpreCompletion c{co_await silkpre::AsyncCall{queue, submission}};
+//
+// suspends the coroutine until whoever drains the queue hands the completion to silkpre::resume,
+// so the coroutine resumes on the draining thread (typically the interpreter's event loop).
+
+#include <silkpre/async.h>
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <cstdint>
+
+namespace silkpre {
+
+class AsyncCall {
+  public:
+    AsyncCall(SilkpreQueue* queue, const SilkpreSubmission& submission) noexcept
+        : queue_{queue}, submission_{submission} {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        handle_ = handle;
+        submission_.user_data = reinterpret_cast<uintptr_t>(this);
+        if (silkpre_queue_submit(queue_, &submission_, 1) == 1) {
+            return true;
+        }
+        // The queue is full: run the call inline rather than failing it
+        const SilkpreSubmission& s{submission_};
+        completion_ = {s.user_data, SILKPRE_SUCCESS, 0, {nullptr, 0}};
+        completion_.status = silkpre_execute(s.contract, s.input, s.input_len, s.evmc_revision, s.gas_limit,
+                                             &completion_.gas_used, &completion_.output);
+        return false;
+    }
+
+    SilkpreCompletion await_resume() const noexcept { return completion_; }
+
+  private:
+    friend void resume(const SilkpreCompletion& completion) noexcept;
+
+    SilkpreQueue* queue_;
+    SilkpreSubmission submission_;
+    SilkpreCompletion completion_{};
+    std::coroutine_handle<> handle_;
+};
+
+//! \brief Resumes the coroutine awaiting the completion, which must come from an AsyncCall
+inline void resume(const SilkpreCompletion& completion) noexcept {
+    auto* call{reinterpret_cast<AsyncCall*>(static_cast<uintptr_t>(completion.user_data))};
+    call->completion_ = completion;
+    call->handle_.resume();
+}
+
+}  // namespace silkpre
+
+#endif
+
+#endif  // SILKPRE_ASYNC_HPP_
@@ -0,0 +1,133 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <silkpre/thread_pool.hpp>
+
+namespace {
+
+// Job indices in decreasing order of gas; the owner takes from the front, thieves from the back
+struct alignas(64) Queue {
+    std::mutex mutex;
+    std::vector<size_t> jobs;
+    size_t head{0};
+    size_t tail{0};
+};
+
+// Shared with the pool tasks, which may outlive the call when they start after all jobs are taken
+struct Batch {
+    Batch(SilkpreBatchJob* j, int rev, size_t num_queues)
+        : jobs{j}, evmc_revision{rev}, queues{new Queue[num_queues]}, num_queues{num_queues} {}
+
+    bool pop(size_t self, size_t& job) noexcept {
+        {
+            Queue& q{queues[self]};
+            std::lock_guard lock{q.mutex};
+            if (q.head < q.tail) {
+                job = q.jobs[q.head++];
+                return true;
+            }
+        }
+        for (size_t k{1}; k < num_queues; ++k) {
+            Queue& q{queues[(self + k) % num_queues]};
+            std::lock_guard lock{q.mutex};
+            if (q.head < q.tail) {
+                job = q.jobs[--q.tail];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t self) noexcept {
+        for (size_t j; pop(self, j);) {
+            SilkpreBatchJob& job{jobs[j]};
+            job.status = silkpre_execute(contracts[j], job.input, job.input_len, evmc_revision, job.gas_limit,
+                                         &job.gas_used, &job.output);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard lock{mutex};
+                done.notify_all();
+            }
+        }
+    }
+
+    SilkpreBatchJob* jobs;
+    int evmc_revision;
+    std::vector<const SilkpreContractDescriptor*> contracts;
+    std::unique_ptr<Queue[]> queues;
+    size_t num_queues;
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+}  // namespace
+
+void silkpre_execute_batch(SilkpreBatchJob* jobs, size_t n, int evmc_revision, size_t num_threads) {
+    silkpre::ThreadPool& pool{silkpre::ThreadPool::instance()};
+    const size_t max_threads{num_threads ? num_threads : pool.size() + 1};
+
+    // Calls that fail up front are settled here; the gas of the others is their estimated cost
+    std::vector<const SilkpreContractDescriptor*> contracts(n);
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(n);
+    for (size_t i{0}; i < n; ++i) {
+        SilkpreBatchJob& job{jobs[i]};
+        job.output = {nullptr, 0};
+        contracts[i] = silkpre_lookup(job.address, evmc_revision);
+        if (!contracts[i]) {
+            job.status = SILKPRE_NOT_A_PRECOMPILE;
+            job.gas_used = 0;
+            continue;
+        }
+        const uint64_t gas{contracts[i]->gas(job.input, job.input_len, evmc_revision)};
+        if (gas > job.gas_limit) {
+            job.status = SILKPRE_OUT_OF_GAS;
+            job.gas_used = job.gas_limit;
+            continue;
+        }
+        order.emplace_back(gas, i);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    const size_t num_queues{std::max<size_t>(1, std::min(max_threads, order.size()))};
+    auto batch{std::make_shared<Batch>(jobs, evmc_revision, num_queues)};
+    batch->contracts = std::move(contracts);
+    batch->remaining.store(order.size(), std::memory_order_relaxed);
+    // Dealt round-robin, so that every queue starts with one of the most expensive jobs
+    for (size_t k{0}; k < order.size(); ++k) {
+        Queue& q{batch->queues[k % num_queues]};
+        q.jobs.push_back(order[k].second);
+        ++q.tail;
+    }
+
+    for (size_t k{1}; k < num_queues; ++k) {
+        pool.post([batch, k] { batch->work(k); });
+    }
+    batch->work(0);
+
+    std::unique_lock lock{batch->mutex};
+    batch->done.wait(lock, [&] { return batch->remaining.load(std::memory_order_acquire) == 0; });
+}
@@ -0,0 +1,56 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_BATCH_H_
+#define SILKPRE_BATCH_H_
+
+// Parallel execution of the many precompile calls of a block
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct SilkpreBatchJob {
+    uint8_t address[20];
+    const uint8_t* input;
+    size_t input_len;
+    uint64_t gas_limit;
+
+    // Set by silkpre_execute_batch, as by silkpre_execute
+    SilkpreStatus status;
+    uint64_t gas_used;
+    SilkpreOutput output;  // set on success only and has to be freed then
+} SilkpreBatchJob;
+
+//! \brief Executes a list of calls to any precompiles, spreading them over threads
+//! \param [in,out] jobs : the calls; addresses that aren't precompiles get SILKPRE_NOT_A_PRECOMPILE and no gas used
+//! \param [in] n : number of jobs
+//! \param [in] num_threads : upper bound on the threads working on the batch, including the calling one;
+//!                           0 for the calling thread plus the library's pool
+//! Jobs are started in decreasing order of gas, so that expensive ones don't end up last on a single thread,
+//! and idle threads steal the remaining jobs of busy ones. Blocks until every job is done.
+void silkpre_execute_batch(SilkpreBatchJob* jobs, size_t n, int evmc_revision, size_t num_threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_BATCH_H_
@@ -18,6 +18,22 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <silkpre/cpu.h>
+#include <silkpre/dispatch.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SILKPRE_BLAKE2B_X86 1
+#include <immintrin.h>
+#endif
+
+#if _MSC_VER
+#define ALWAYS_INLINE __forceinline
+#elif __has_attribute(always_inline)
+#define ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE
+#endif
+
 static const uint64_t blake2b_IV[8] = {
     0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
     0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
@@ -64,7 +80,9 @@ static inline uint64_t rotr64(const uint64_t w, const unsigned c) { return (w >>
         G(r, 7, v[3], v[4], v[9], v[14]);  \
     } while (0)
 
-void silkpre_blake2b_compress(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r) {
+static inline ALWAYS_INLINE bool blake2b_compress_implementation(SilkpreBlake2bState* S,
+                                                                const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES],
+                                                                size_t r, bool (*expired)(void)) {
     uint64_t m[16];
     uint64_t v[16];
     size_t i;
@@ -86,14 +104,161 @@ void silkpre_blake2b_compress(SilkpreBlake2bState* S, const uint8_t block[SILKPR
     v[14] = blake2b_IV[6] ^ S->f[0];
     v[15] = blake2b_IV[7] ^ S->f[1];
 
-    for (i = 0; i < r; ++i) {
-        ROUND(i % 10);
+    for (i = 0; i < r;) {
+        const size_t end = r - i > SILKPRE_BLAKE2B_POLL_ROUNDS ? i + SILKPRE_BLAKE2B_POLL_ROUNDS : r;
+        for (; i < end; ++i) {
+            ROUND(i % 10);
+        }
+        if (i < r && expired && expired()) {
+            return false;
+        }
     }
 
     for (i = 0; i < 8; ++i) {
         S->h[i] = S->h[i] ^ v[i] ^ v[i + 8];
     }
+    return true;
 }
 
 #undef G
 #undef ROUND
+
+static bool blake2b_compress_generic(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES],
+                                     size_t r, bool (*expired)(void)) {
+    return blake2b_compress_implementation(S, block, r, expired);
+}
+
+#if defined(SILKPRE_BLAKE2B_X86)
+
+// Same code with RORX for the rotations
+__attribute__((target("bmi2"))) static bool blake2b_compress_bmi2(SilkpreBlake2bState* S,
+                                                                  const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES],
+                                                                  size_t r, bool (*expired)(void)) {
+    return blake2b_compress_implementation(S, block, r, expired);
+}
+
+// The four rows of the state in one 256-bit register each: G runs on all columns, then all diagonals, at once.
+// ROTR32/24/16/63 have to be defined by the user.
+#define HALF_ROUND(a, b, c, d, x, y)                      \
+    do {                                                  \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);  \
+        d = ROTR32(_mm256_xor_si256(d, a));               \
+        c = _mm256_add_epi64(c, d);                       \
+        b = ROTR24(_mm256_xor_si256(b, c));               \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);  \
+        d = ROTR16(_mm256_xor_si256(d, a));               \
+        c = _mm256_add_epi64(c, d);                       \
+        b = ROTR63(_mm256_xor_si256(b, c));               \
+    } while (0)
+
+#define COMPRESS_SIMD(S, block, r, expired)                                                                            \
+    do {                                                                                                               \
+        uint64_t m[16];                                                                                                \
+        for (size_t i = 0; i < 16; ++i) {                                                                              \
+            m[i] = load64(block + i * sizeof(m[i]));                                                                   \
+        }                                                                                                              \
+        const __m256i h0 = _mm256_loadu_si256((const __m256i*)&S->h[0]);                                               \
+        const __m256i h1 = _mm256_loadu_si256((const __m256i*)&S->h[4]);                                               \
+        __m256i a = h0;                                                                                                \
+        __m256i b = h1;                                                                                                \
+        __m256i c = _mm256_loadu_si256((const __m256i*)&blake2b_IV[0]);                                                \
+        __m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&blake2b_IV[4]),                               \
+                                     _mm256_set_epi64x((int64_t)S->f[1], (int64_t)S->f[0], (int64_t)S->t[1],           \
+                                                       (int64_t)S->t[0]));                                             \
+        for (size_t i = 0; i < r;) {                                                                                   \
+            const size_t end = r - i > SILKPRE_BLAKE2B_POLL_ROUNDS ? i + SILKPRE_BLAKE2B_POLL_ROUNDS : r;              \
+            for (; i < end; ++i) {                                                                                     \
+                const uint8_t* s = blake2b_sigma[i % 10];                                                              \
+                __m256i x = _mm256_set_epi64x((int64_t)m[s[6]], (int64_t)m[s[4]], (int64_t)m[s[2]], (int64_t)m[s[0]]); \
+                __m256i y = _mm256_set_epi64x((int64_t)m[s[7]], (int64_t)m[s[5]], (int64_t)m[s[3]], (int64_t)m[s[1]]); \
+                HALF_ROUND(a, b, c, d, x, y);                                                                          \
+                b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));                                              \
+                c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));                                              \
+                d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));                                              \
+                x = _mm256_set_epi64x((int64_t)m[s[14]], (int64_t)m[s[12]], (int64_t)m[s[10]], (int64_t)m[s[8]]);      \
+                y = _mm256_set_epi64x((int64_t)m[s[15]], (int64_t)m[s[13]], (int64_t)m[s[11]], (int64_t)m[s[9]]);      \
+                HALF_ROUND(a, b, c, d, x, y);                                                                          \
+                b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));                                              \
+                c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));                                              \
+                d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));                                              \
+            }                                                                                                          \
+            if (i < r && expired && expired()) {                                                                       \
+                return false;                                                                                          \
+            }                                                                                                          \
+        }                                                                                                              \
+        _mm256_storeu_si256((__m256i*)&S->h[0], _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));                         \
+        _mm256_storeu_si256((__m256i*)&S->h[4], _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));                         \
+        return true;                                                                                                   \
+    } while (0)
+
+#define ROTR32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define ROTR24(x) _mm256_shuffle_epi8((x), rot24)
+#define ROTR16(x) _mm256_shuffle_epi8((x), rot16)
+#define ROTR63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+__attribute__((target("avx2"))) static bool blake2b_compress_avx2(SilkpreBlake2bState* S,
+                                                                  const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES],
+                                                                  size_t r, bool (*expired)(void)) {
+    const __m256i rot24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,  //
+                                           3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,  //
+                                           2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    COMPRESS_SIMD(S, block, r, expired);
+}
+
+#undef ROTR32
+#undef ROTR24
+#undef ROTR16
+#undef ROTR63
+
+#define ROTR32(x) _mm256_ror_epi64((x), 32)
+#define ROTR24(x) _mm256_ror_epi64((x), 24)
+#define ROTR16(x) _mm256_ror_epi64((x), 16)
+#define ROTR63(x) _mm256_ror_epi64((x), 63)
+
+__attribute__((target("avx2,avx512f,avx512vl"))) static bool blake2b_compress_avx512(
+    SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r, bool (*expired)(void)) {
+    COMPRESS_SIMD(S, block, r, expired);
+}
+
+#undef ROTR32
+#undef ROTR24
+#undef ROTR16
+#undef ROTR63
+#undef COMPRESS_SIMD
+#undef HALF_ROUND
+
+#endif  // defined(SILKPRE_BLAKE2B_X86)
+
+struct blake2b_kernel {
+    bool (*fn)(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r,
+               bool (*expired)(void));
+    const char* name;
+};
+
+static struct blake2b_kernel select_blake2b_kernel(uint32_t features) {
+#if defined(SILKPRE_BLAKE2B_X86)
+    if (features & SILKPRE_CPU_AVX512) {
+        return (struct blake2b_kernel){blake2b_compress_avx512, "x86_avx512"};
+    }
+    if (features & SILKPRE_CPU_AVX2) {
+        return (struct blake2b_kernel){blake2b_compress_avx2, "x86_avx2"};
+    }
+    if (features & SILKPRE_CPU_BMI2) {
+        return (struct blake2b_kernel){blake2b_compress_bmi2, "x86_bmi2"};
+    }
+#endif
+    (void)features;
+    return (struct blake2b_kernel){blake2b_compress_generic, "generic"};
+}
+
+const char* silkpre_blake2b_kernel(uint32_t features) { return select_blake2b_kernel(features).name; }
+
+void silkpre_blake2b_compress(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r) {
+    select_blake2b_kernel(silkpre_cpu_features()).fn(S, block, r, NULL);
+}
+
+bool silkpre_blake2b_compress_polled(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r,
+                                     bool (*expired)(void)) {
+    return select_blake2b_kernel(silkpre_cpu_features()).fn(S, block, r, expired);
+}
@@ -18,6 +18,7 @@
 #ifndef SILKPRE_BLAKE2B_H_
 #define SILKPRE_BLAKE2B_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -25,7 +26,7 @@
 extern "C" {
 #endif
 
-enum { SILKPRE_BLAKE2B_BLOCKBYTES = 128 };
+enum { SILKPRE_BLAKE2B_BLOCKBYTES = 128, SILKPRE_BLAKE2B_POLL_ROUNDS = 1000 };
 
 typedef struct SilkpreBlake2bState {
     uint64_t h[8];
@@ -36,6 +37,12 @@ typedef struct SilkpreBlake2bState {
 // https://tools.ietf.org/html/rfc7693#section-3.2
 void silkpre_blake2b_compress(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r);
 
+//! \brief Same as silkpre_blake2b_compress, but stops early once expired returns true
+//! \param [in] expired : polled every SILKPRE_BLAKE2B_POLL_ROUNDS rounds
+//! \return false if it stopped early; S is left as it was then
+bool silkpre_blake2b_compress_polled(SilkpreBlake2bState* S, const uint8_t block[SILKPRE_BLAKE2B_BLOCKBYTES], size_t r,
+                                     bool (*expired)(void));
+
 #if defined(__cplusplus)
 }
 #endif
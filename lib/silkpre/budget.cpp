@@ -0,0 +1,66 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "budget.hpp"
+
+#include <algorithm>
+
+namespace {
+
+thread_local silkpre::budget::Scope* current_scope{nullptr};
+
+}  // namespace
+
+SilkpreStatus silkpre_execute_budget(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                                     int evmc_revision, uint64_t gas_limit, uint64_t budget_ns, uint64_t* gas_used,
+                                     SilkpreOutput* output) {
+    silkpre::budget::Scope scope{budget_ns};
+    const SilkpreStatus status{silkpre_execute(contract, input, len, evmc_revision, gas_limit, gas_used, output)};
+    if (status == SILKPRE_INVALID_INPUT && scope.exceeded()) {
+        return SILKPRE_BUDGET_EXCEEDED;
+    }
+    return status;
+}
+
+namespace silkpre::budget {
+
+bool active() noexcept { return current_scope != nullptr; }
+
+bool expired() noexcept {
+    Scope* scope{current_scope};
+    if (!scope) {
+        return false;
+    }
+    if (!scope->exceeded_ && std::chrono::steady_clock::now() >= scope->deadline_) {
+        scope->exceeded_ = true;
+    }
+    return scope->exceeded_;
+}
+
+Scope::Scope(uint64_t budget_ns) noexcept : previous_{current_scope} {
+    const auto now{std::chrono::steady_clock::now()};
+    // Saturates rather than overflows for budgets of centuries
+    const auto headroom{std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::time_point::max() - now)};
+    const std::chrono::nanoseconds budget{
+        static_cast<int64_t>(std::min(budget_ns, static_cast<uint64_t>(headroom.count())))};
+    deadline_ = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+    current_scope = this;
+}
+
+Scope::~Scope() { current_scope = previous_; }
+
+}  // namespace silkpre::budget
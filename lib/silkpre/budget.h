@@ -0,0 +1,46 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_BUDGET_H_
+#define SILKPRE_BUDGET_H_
+
+// Wall-clock bounded execution. Gas bounds the work of a call but not evenly: some inputs of
+// modexp and blake2f take much longer per unit of gas than anything else, so RPC servers
+// running untrusted calls can cap the time of each call on top of its gas.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! \brief Same as silkpre_execute, but gives up once the call has run for budget_ns nanoseconds
+//! \return SILKPRE_BUDGET_EXCEEDED if it did; all of gas_limit is charged then and there is no output.
+//! modexp checks the budget after each window of the exponent unless it takes about a millisecond
+//! or less, and blake2f every 1000 rounds; the other contracts run to completion. Whether a call fits
+//! depends on the machine and its load, so this is meant for eth_call & co. and never for block execution.
+SilkpreStatus silkpre_execute_budget(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                                     int evmc_revision, uint64_t gas_limit, uint64_t budget_ns, uint64_t* gas_used,
+                                     SilkpreOutput* output);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_BUDGET_H_
@@ -0,0 +1,57 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_BUDGET_HPP_
+#define SILKPRE_BUDGET_HPP_
+
+#include <stdint.h>
+
+#include <chrono>
+
+#include <silkpre/budget.h>
+
+namespace silkpre::budget {
+
+// Whether the calling thread runs under the deadline of a Scope
+bool active() noexcept;
+
+// Whether the deadline of the enclosing Scope, if any, has passed; run functions call it at
+// safe points and fail once it returns true.
+bool expired() noexcept;
+
+// Sets a deadline for the run functions called on the calling thread for the scope's lifetime
+class Scope {
+  public:
+    explicit Scope(uint64_t budget_ns) noexcept;
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // Whether a run function gave up because of the deadline
+    bool exceeded() const noexcept { return exceeded_; }
+
+  private:
+    friend bool expired() noexcept;
+
+    std::chrono::steady_clock::time_point deadline_;
+    bool exceeded_{false};
+    Scope* previous_;
+};
+
+}  // namespace silkpre::budget
+
+#endif  // SILKPRE_BUDGET_HPP_
@@ -0,0 +1,103 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cache.h"
+
+#include <atomic>
+#include <memory>
+
+#include <silkpre/call_store.hpp>
+
+namespace {
+
+constexpr size_t kDefaultShards{16};
+constexpr uint64_t kDefaultAdmissionGas{3'000};
+constexpr uint64_t kNeverAdmit{UINT64_MAX};
+
+}  // namespace
+
+struct SilkpreCache {
+    SilkpreCache(size_t capacity_bytes, size_t num_shards) : results{capacity_bytes, num_shards} {}
+
+    silkpre::CallStore results;
+    std::atomic<uint64_t> min_gas[SILKPRE_NUMBER_OF_CONTRACTS];
+};
+
+SilkpreCache* silkpre_cache_create(size_t capacity_bytes, size_t num_shards) {
+    auto* cache{new SilkpreCache{capacity_bytes, num_shards ? num_shards : kDefaultShards}};
+    for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+        cache->min_gas[i].store(kDefaultAdmissionGas, std::memory_order_relaxed);
+    }
+    for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+        if (silkpre::is_hash_like(*silkpre_contract_descriptor(i))) {
+            cache->min_gas[i].store(kNeverAdmit, std::memory_order_relaxed);
+        }
+    }
+    return cache;
+}
+
+void silkpre_cache_destroy(SilkpreCache* cache) { delete cache; }
+
+void silkpre_cache_set_admission_threshold(SilkpreCache* cache, size_t contract_index, uint64_t min_gas) {
+    if (contract_index < SILKPRE_NUMBER_OF_CONTRACTS) {
+        cache->min_gas[contract_index].store(min_gas, std::memory_order_relaxed);
+    }
+}
+
+SilkpreStatus silkpre_cache_execute(SilkpreCache* cache, const SilkpreContractDescriptor* contract,
+                                    const uint8_t* input, size_t len, int evmc_revision, uint64_t gas_limit,
+                                    uint64_t* gas_used, SilkpreOutput* output) {
+    *output = {nullptr, 0};
+
+    if (!(contract->flags & SILKPRE_CONTRACT_PURE)) {
+        return silkpre_execute(contract, input, len, evmc_revision, gas_limit, gas_used, output);
+    }
+
+    const uint64_t gas{contract->gas(input, len, evmc_revision)};
+    if (gas > gas_limit) {
+        *gas_used = gas_limit;
+        return SILKPRE_OUT_OF_GAS;
+    }
+    if (gas < cache->min_gas[contract->index].load(std::memory_order_relaxed)) {
+        return silkpre_execute(contract, input, len, evmc_revision, gas_limit, gas_used, output);
+    }
+
+    const silkpre::CallKey key{silkpre::make_call_key(contract->index, input, len)};
+    if (const auto hit{cache->results.get(key)}) {
+        return silkpre::replay_call(**hit, gas, gas_limit, gas_used, output);
+    }
+
+    const SilkpreStatus status{silkpre_execute(contract, input, len, evmc_revision, gas_limit, gas_used, output)};
+    if (status == SILKPRE_OUT_OF_GAS) {
+        return status;
+    }
+    auto res{std::make_shared<silkpre::CallResult>()};
+    res->success = status == SILKPRE_SUCCESS;
+    if (res->success) {
+        res->bytes.assign(output->data, output->size);
+    }
+    const size_t weight{silkpre::call_weight(*res)};
+    cache->results.put(key, std::move(res), weight);
+    return status;
+}
+
+void silkpre_cache_stats(const SilkpreCache* cache, SilkpreCacheStats* stats) {
+    const silkpre::LruCacheStats s{cache->results.stats()};
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->insertions = s.insertions;
+    stats->evictions = s.evictions;
+}
@@ -0,0 +1,65 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_CACHE_H_
+#define SILKPRE_CACHE_H_
+
+// Memoization of pure precompile calls, useful when the same calls are re-executed
+// (reorgs, tracing, eth_call fan-out).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct SilkpreCache SilkpreCache;
+
+typedef struct SilkpreCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+} SilkpreCacheStats;
+
+//! \brief Creates a cache keyed by (contract, SHA-256 of the input)
+//! \param [in] capacity_bytes : upper bound on the memory held by cached results
+//! \param [in] num_shards : number of independently locked shards; 0 for the default
+//! By default calls of at least 3000 gas are admitted, except for the hash-like contracts
+//! (sha256, ripemd160, identity, blake2f) that are cheaper to re-run than to look up.
+SilkpreCache* silkpre_cache_create(size_t capacity_bytes, size_t num_shards);
+
+void silkpre_cache_destroy(SilkpreCache* cache);
+
+//! \brief Only calls charged at least min_gas are cached; UINT64_MAX disables caching of the contract.
+//! Thread-safe; silkpre_cache_execute calls already in flight may still see the previous threshold.
+void silkpre_cache_set_admission_threshold(SilkpreCache* cache, size_t contract_index, uint64_t min_gas);
+
+//! \brief Same as silkpre_execute, but skips the run of admitted contracts when the result is cached
+SilkpreStatus silkpre_cache_execute(SilkpreCache* cache, const SilkpreContractDescriptor* contract,
+                                    const uint8_t* input, size_t len, int evmc_revision, uint64_t gas_limit,
+                                    uint64_t* gas_used, SilkpreOutput* output);
+
+void silkpre_cache_stats(const SilkpreCache* cache, SilkpreCacheStats* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_CACHE_H_
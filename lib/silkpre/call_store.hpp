@@ -0,0 +1,103 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_CALL_STORE_HPP_
+#define SILKPRE_CALL_STORE_HPP_
+
+// Results of pure precompile calls keyed by (contract, SHA-256 of the input),
+// shared by the call cache and the pre-execution service.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <silkpre/arena.hpp>
+#include <silkpre/lru_cache.hpp>
+#include <silkpre/precompile.h>
+#include <silkpre/sha256.h>
+
+namespace silkpre {
+
+struct CallKey {
+    uint32_t index;
+    std::array<uint8_t, 32> digest;
+
+    bool operator==(const CallKey& other) const noexcept { return index == other.index && digest == other.digest; }
+};
+
+inline CallKey make_call_key(uint32_t index, const uint8_t* input, size_t len) noexcept {
+    CallKey key{index, {}};
+    silkpre_sha256(key.digest.data(), input, len, /*use_cpu_extensions=*/true);
+    return key;
+}
+
+struct CallKeyHash {
+    size_t operator()(const CallKey& key) const noexcept {
+        // The digest is already uniformly distributed
+        uint64_t h;
+        std::memcpy(&h, key.digest.data(), sizeof(h));
+        return static_cast<size_t>(h ^ key.index);
+    }
+};
+
+struct CallResult {
+    bool success;
+    std::basic_string<uint8_t> bytes;
+};
+
+// Hashing the input for the key costs about as much as running these
+inline bool is_hash_like(const SilkpreContractDescriptor& contract) noexcept {
+    for (const char* name : {"sha256", "ripemd160", "identity", "blake2f"}) {
+        if (std::strcmp(contract.name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+using CallStore = ShardedLruCache<CallKey, std::shared_ptr<const CallResult>, CallKeyHash>;
+
+// Rough per-entry bookkeeping cost: list node, map node & the shared result
+inline constexpr size_t kCallEntryOverhead{160};
+
+inline size_t call_weight(const CallResult& res) noexcept { return kCallEntryOverhead + res.bytes.size(); }
+
+// Completes a silkpre_execute-like call from a stored result
+inline SilkpreStatus replay_call(const CallResult& res, uint64_t gas, uint64_t gas_limit, uint64_t* gas_used,
+                                 SilkpreOutput* output) noexcept {
+    if (!res.success) {
+        *gas_used = gas_limit;
+        return SILKPRE_INVALID_INPUT;
+    }
+    // Non-null even when empty: {nullptr, 0} means failure
+    uint8_t* out{alloc_output(res.bytes.empty() ? 1 : res.bytes.size())};
+    if (!out) {
+        *gas_used = gas_limit;
+        return SILKPRE_INVALID_INPUT;
+    }
+    std::memcpy(out, res.bytes.data(), res.bytes.size());
+    *gas_used = gas;
+    *output = {out, res.bytes.size()};
+    return SILKPRE_SUCCESS;
+}
+
+}  // namespace silkpre
+
+#endif  // SILKPRE_CALL_STORE_HPP_
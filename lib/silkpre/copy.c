@@ -0,0 +1,64 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "copy.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SILKPRE_COPY_X86 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SILKPRE_COPY_X86)
+
+// SSE2 is part of x86-64, so no dispatch is needed
+static void stream_copy(uint8_t* dst, const uint8_t* src, size_t n) {
+    // Non-temporal stores need an aligned destination
+    const size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    n -= head;
+
+    for (; n >= 64; n -= 64, src += 64, dst += 64) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(src + 0));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+        const __m128i d = _mm_loadu_si128((const __m128i*)(src + 48));
+        _mm_stream_si128((__m128i*)(dst + 0), a);
+        _mm_stream_si128((__m128i*)(dst + 16), b);
+        _mm_stream_si128((__m128i*)(dst + 32), c);
+        _mm_stream_si128((__m128i*)(dst + 48), d);
+    }
+    // Orders the weakly-ordered stores before anything that follows, e.g. handing the output to another thread
+    _mm_sfence();
+
+    memcpy(dst, src, n);
+}
+
+#endif  // defined(SILKPRE_COPY_X86)
+
+void silkpre_copy(void* dst, const void* src, size_t n) {
+#if defined(SILKPRE_COPY_X86)
+    if (n >= SILKPRE_STREAMING_COPY_THRESHOLD) {
+        stream_copy((uint8_t*)dst, (const uint8_t*)src, n);
+        return;
+    }
+#endif
+    memcpy(dst, src, n);
+}
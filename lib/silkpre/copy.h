@@ -0,0 +1,37 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_COPY_H_
+#define SILKPRE_COPY_H_
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Copies of at least this many bytes bypass the caches
+enum { SILKPRE_STREAMING_COPY_THRESHOLD = 1 << 22 };
+
+//! \brief Same as memcpy, but large copies are written with non-temporal stores where available,
+//! so that copying a big output (e.g. of identity) doesn't evict the caller's working set
+void silkpre_copy(void* dst, const void* src, size_t n);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_COPY_H_
@@ -0,0 +1,208 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cpu.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include <silkpre/dispatch.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__)
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+void cpuid(uint32_t regs[4], uint32_t leaf) noexcept {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), 0);
+    for (size_t i{0}; i < 4; ++i) {
+        regs[i] = static_cast<uint32_t>(r[i]);
+    }
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register state the OS saves on context switches
+uint64_t xcr0() noexcept {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+uint32_t detect() noexcept {
+    uint32_t regs[4];
+    cpuid(regs, 0);
+    const uint32_t max_leaf{regs[0]};
+    if (max_leaf < 7) {
+        return 0;
+    }
+
+    cpuid(regs, 1);
+    const bool sse41{(regs[2] & (1u << 19)) != 0};
+    const bool osxsave{(regs[2] & (1u << 27)) != 0};
+    const uint64_t xcr{osxsave ? xcr0() : 0};
+    const bool avx_state{(xcr & 0x6) == 0x6};
+    const bool avx512_state{avx_state && (xcr & 0xe0) == 0xe0};
+
+    cpuid(regs, 7);
+    const uint32_t ebx{regs[1]};
+    uint32_t features{0};
+    if ((ebx & (1u << 3)) && (ebx & (1u << 8))) {
+        features |= SILKPRE_CPU_BMI2;
+    }
+    if (ebx & (1u << 19)) {
+        features |= SILKPRE_CPU_ADX;
+    }
+    if (avx_state && (ebx & (1u << 5))) {
+        features |= SILKPRE_CPU_AVX2;
+    }
+    if (avx512_state && (ebx & (1u << 16)) && (ebx & (1u << 30)) && (ebx & (1u << 31))) {
+        features |= SILKPRE_CPU_AVX512;
+    }
+    if (sse41 && (ebx & (1u << 29))) {
+        features |= SILKPRE_CPU_SHA;
+    }
+    return features;
+}
+
+#elif defined(__aarch64__) && defined(__linux__)
+
+uint32_t detect() noexcept {
+    const unsigned long hwcap{getauxval(AT_HWCAP)};
+    uint32_t features{0};
+    if (hwcap & HWCAP_SHA2) {
+        features |= SILKPRE_CPU_ARM_SHA2;
+    }
+    if (hwcap & HWCAP_SHA3) {
+        features |= SILKPRE_CPU_ARM_SHA3;
+    }
+    return features;
+}
+
+#elif defined(__aarch64__) && defined(__APPLE__)
+
+uint32_t detect() noexcept {
+    int64_t sha3{0};
+    size_t size{sizeof(sha3)};
+    if (sysctlbyname("hw.optional.armv8_2_sha3", &sha3, &size, nullptr, 0) == 0 && sha3 == 1) {
+        // SHA3 is a proxy for SHA2 (sysctl hw doesn't list SHA2 for Apple M1)
+        return SILKPRE_CPU_ARM_SHA2 | SILKPRE_CPU_ARM_SHA3;
+    }
+    return 0;
+}
+
+#else
+
+uint32_t detect() noexcept { return 0; }
+
+#endif
+
+uint32_t tier_mask(SilkpreCpuTier tier) noexcept {
+    switch (tier) {
+        case SILKPRE_CPU_TIER_GENERIC:
+            return 0;
+        case SILKPRE_CPU_TIER_BMI2:
+            return SILKPRE_CPU_BMI2 | SILKPRE_CPU_ADX;
+        case SILKPRE_CPU_TIER_AVX2:
+            return SILKPRE_CPU_BMI2 | SILKPRE_CPU_ADX | SILKPRE_CPU_AVX2;
+        case SILKPRE_CPU_TIER_AVX512:
+            return SILKPRE_CPU_BMI2 | SILKPRE_CPU_ADX | SILKPRE_CPU_AVX2 | SILKPRE_CPU_AVX512;
+        case SILKPRE_CPU_TIER_SHA:
+            return SILKPRE_CPU_BMI2 | SILKPRE_CPU_ADX | SILKPRE_CPU_AVX2 | SILKPRE_CPU_AVX512 | SILKPRE_CPU_SHA;
+        case SILKPRE_CPU_TIER_NATIVE:
+            break;
+    }
+    return UINT32_MAX;
+}
+
+uint32_t env_mask() noexcept {
+    static constexpr const char* kTierNames[]{"generic", "bmi2", "avx2", "avx512", "sha", "native"};
+    const char* env{std::getenv("SILKPRE_CPU_TIER")};
+    if (env) {
+        for (size_t i{0}; i < std::size(kTierNames); ++i) {
+            if (std::strcmp(env, kTierNames[i]) == 0) {
+                return tier_mask(static_cast<SilkpreCpuTier>(i));
+            }
+        }
+    }
+    return UINT32_MAX;
+}
+
+struct State {
+    uint32_t detected{detect()};
+    std::atomic<uint32_t> features{detected & env_mask()};
+};
+
+State& state() noexcept {
+    static State s;
+    return s;
+}
+
+}  // namespace
+
+uint32_t silkpre_cpu_detected_features(void) { return state().detected; }
+
+uint32_t silkpre_cpu_features(void) { return state().features.load(std::memory_order_relaxed); }
+
+uint32_t silkpre_cpu_restrict(uint32_t mask) {
+    State& s{state()};
+    const uint32_t features{s.detected & mask};
+    s.features.store(features, std::memory_order_relaxed);
+    return features;
+}
+
+uint32_t silkpre_cpu_set_tier(SilkpreCpuTier tier) { return silkpre_cpu_restrict(tier_mask(tier)); }
+
+const char* silkpre_cpu_kernel(SilkpreKernel kernel) {
+    const uint32_t features{silkpre_cpu_features()};
+    switch (kernel) {
+        case SILKPRE_KERNEL_SHA256:
+            return silkpre_sha256_kernel(features);
+        case SILKPRE_KERNEL_BLAKE2B:
+            return silkpre_blake2b_kernel(features);
+        case SILKPRE_KERNEL_RMD160:
+            return silkpre_rmd160_kernel(features);
+        case SILKPRE_KERNEL_P256:
+            return silkpre_p256_kernel(features);
+        case SILKPRE_KERNEL_KECCAK:
+            return silkpre_keccak_kernel(features);
+    }
+    return nullptr;
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_CPU_H_
+#define SILKPRE_CPU_H_
+
+// Runtime selection of CPU-specific kernels.
+//
+// Features are detected on first use. They can be restricted, but never extended, either
+// with the SILKPRE_CPU_TIER environment variable (generic, bmi2, avx2, avx512, sha or native)
+// read at detection, or with silkpre_cpu_set_tier / silkpre_cpu_restrict at any time.
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum {
+    SILKPRE_CPU_BMI2 = 1 << 0,      // x86 BMI1 & BMI2
+    SILKPRE_CPU_ADX = 1 << 1,       // x86 ADCX/ADOX
+    SILKPRE_CPU_AVX2 = 1 << 2,      // with OS support
+    SILKPRE_CPU_AVX512 = 1 << 3,    // AVX-512 F, VL & BW with OS support
+    SILKPRE_CPU_SHA = 1 << 4,       // x86 SHA extensions & SSE4.1
+    SILKPRE_CPU_ARM_SHA2 = 1 << 5,  // ARMv8 SHA-256 instructions
+    SILKPRE_CPU_ARM_SHA3 = 1 << 6,  // ARMv8.2 SHA-3 instructions
+};
+
+// Each tier includes the ones before it
+typedef enum SilkpreCpuTier {
+    SILKPRE_CPU_TIER_GENERIC = 0,
+    SILKPRE_CPU_TIER_BMI2 = 1,    // + ADX
+    SILKPRE_CPU_TIER_AVX2 = 2,
+    SILKPRE_CPU_TIER_AVX512 = 3,
+    SILKPRE_CPU_TIER_SHA = 4,     // + SHA-NI
+    SILKPRE_CPU_TIER_NATIVE = 5,  // everything detected, ARM extensions included
+} SilkpreCpuTier;
+
+typedef enum SilkpreKernel {
+    SILKPRE_KERNEL_SHA256 = 0,
+    SILKPRE_KERNEL_BLAKE2B = 1,
+    SILKPRE_KERNEL_RMD160 = 2,
+    SILKPRE_KERNEL_P256 = 3,  // secp256r1 field arithmetic
+    SILKPRE_KERNEL_KECCAK = 4,
+} SilkpreKernel;
+
+//! \brief Features supported by the CPU & OS
+uint32_t silkpre_cpu_detected_features(void);
+
+//! \brief Features the kernels may currently use
+uint32_t silkpre_cpu_features(void);
+
+//! \brief Limits the features the kernels may use to a mask of SILKPRE_CPU_* (intersected with the detected ones)
+//! \return The resulting silkpre_cpu_features()
+//! Takes effect for calls started afterwards on any thread.
+uint32_t silkpre_cpu_restrict(uint32_t mask);
+
+//! \brief Limits the features the kernels may use to those of a tier
+uint32_t silkpre_cpu_set_tier(SilkpreCpuTier tier);
+
+//! \brief Name of the implementation currently selected for a kernel, e.g. "x86_sha" for SHA-256
+const char* silkpre_cpu_kernel(SilkpreKernel kernel);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_CPU_H_
@@ -0,0 +1,38 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_DISPATCH_H_
+#define SILKPRE_DISPATCH_H_
+
+// Internal: names of the kernels each module selects for a set of SILKPRE_CPU_* features
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+const char* silkpre_sha256_kernel(uint32_t features);
+const char* silkpre_blake2b_kernel(uint32_t features);
+const char* silkpre_rmd160_kernel(uint32_t features);
+const char* silkpre_p256_kernel(uint32_t features);
+const char* silkpre_keccak_kernel(uint32_t features);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_DISPATCH_H_
@@ -0,0 +1,94 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ecdh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <silkpre/ecdsa.h>
+#include <silkpre/secp256k1_context.h>
+
+namespace {
+
+// An ECDH takes tens of microseconds, so a few of them per thread pay for starting it
+constexpr size_t kMinPerThread{8};
+constexpr size_t kChunk{4};
+
+// Calls f(i) for every i in [0, n), with threads pulling chunks of indices off a shared counter
+template <class F>
+void parallel_for(size_t n, size_t num_threads, F f) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, std::max<size_t>(1, n / kMinPerThread));
+
+    std::atomic<size_t> next{0};
+    const auto worker{[&] {
+        for (size_t begin; (begin = next.fetch_add(kChunk, std::memory_order_relaxed)) < n;) {
+            const size_t end{std::min(begin + kChunk, n)};
+            for (size_t i{begin}; i < end; ++i) {
+                f(i);
+            }
+        }
+    }};
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t i{1}; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+}  // namespace
+
+bool silkpre_secp256k1_ecdh_batch(const secp256k1_context* context, uint8_t* outputs,
+                                  const secp256k1_pubkey* public_keys, size_t n, const uint8_t private_key[32],
+                                  size_t num_threads) {
+    if (!context) {
+        context = silkpre_secp256k1_context();
+    }
+    // With a valid key and parsed public keys every single ECDH succeeds
+    if (!secp256k1_ec_seckey_verify(context, private_key)) {
+        return false;
+    }
+    parallel_for(n, num_threads, [&](size_t i) {
+        silkpre_secp256k1_ecdh(context, &outputs[32 * i], &public_keys[i], private_key);
+    });
+    return true;
+}
+
+size_t silkpre_secp256k1_ecdh_pairs(const secp256k1_context* context, uint8_t* outputs, bool* results,
+                                    const secp256k1_pubkey* public_keys, const uint8_t* private_keys, size_t n,
+                                    size_t num_threads) {
+    if (!context) {
+        context = silkpre_secp256k1_context();
+    }
+    std::atomic<size_t> valid{0};
+    parallel_for(n, num_threads, [&](size_t i) {
+        results[i] = silkpre_secp256k1_ecdh(context, &outputs[32 * i], &public_keys[i], &private_keys[32 * i]);
+        if (results[i]) {
+            valid.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    return valid.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,60 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_ECDH_H_
+#define SILKPRE_ECDH_H_
+
+// Batched silkpre_secp256k1_ecdh for bursts of devp2p (RLPx) handshakes
+
+#include <secp256k1.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! \brief Computes silkpre_secp256k1_ecdh of a single private key with n public keys
+//! \param [in] context : a secp256k1 context, or NULL for silkpre_secp256k1_context()
+//! \param [out] outputs : n shared x coordinates of 32 bytes each
+//! \param [in] public_keys : n parsed public keys
+//! \param [in] n : number of public keys
+//! \param [in] private_key : 32-byte private key, validated once for the whole batch
+//! \param [in] num_threads : threads to spread the batch over, including the calling one; 0 for all cores
+//! \return Whether the private key is valid; if not, outputs is left untouched
+bool silkpre_secp256k1_ecdh_batch(const secp256k1_context* context, uint8_t* outputs,
+                                  const secp256k1_pubkey* public_keys, size_t n, const uint8_t private_key[32],
+                                  size_t num_threads);
+
+//! \brief Computes silkpre_secp256k1_ecdh for n (private key, public key) pairs
+//! \param [in] context : a secp256k1 context, or NULL for silkpre_secp256k1_context()
+//! \param [out] outputs : n shared x coordinates of 32 bytes each
+//! \param [out] results : n flags, whether the pair's private key is valid
+//! \param [in] public_keys : n parsed public keys
+//! \param [in] private_keys : n private keys of 32 bytes each
+//! \param [in] n : number of pairs
+//! \param [in] num_threads : threads to spread the pairs over, including the calling one; 0 for all cores
+//! \return Number of valid pairs
+size_t silkpre_secp256k1_ecdh_pairs(const secp256k1_context* context, uint8_t* outputs, bool* results,
+                                    const secp256k1_pubkey* public_keys, const uint8_t* private_keys, size_t n,
+                                    size_t num_threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_ECDH_H_
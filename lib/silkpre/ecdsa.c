@@ -18,15 +18,18 @@
 
 #include <string.h>
 
-#include <ethash/keccak.h>
 #include <secp256k1_ecdh.h>
 #include <secp256k1_recovery.h>
 
-//! \brief Tries recover public key used for message signing.
-//! \return An optional Bytes. Should it has no value the recovery has failed
-//! This is different from recover_address as the whole 64 bytes are returned.
-static bool recover(uint8_t public_key[65], const uint8_t message[32], const uint8_t signature[64], bool odd_y_parity,
-                    secp256k1_context* context) {
+#include "keccak.h"
+#include "secp256k1_context.h"
+
+bool silkpre_recover_public_key(uint8_t out[65], const uint8_t message[32], const uint8_t signature[64],
+                                bool odd_y_parity, const secp256k1_context* context) {
+    if (!context) {
+        context = silkpre_secp256k1_context();
+    }
+
     secp256k1_ecdsa_recoverable_signature sig;
     if (!secp256k1_ecdsa_recoverable_signature_parse_compact(context, &sig, signature, odd_y_parity)) {
         return false;
@@ -38,30 +41,28 @@ static bool recover(uint8_t public_key[65], const uint8_t message[32], const uin
     }
 
     size_t key_len = 65;
-    secp256k1_ec_pubkey_serialize(context, public_key, &key_len, &pub_key, SECP256K1_EC_UNCOMPRESSED);
+    secp256k1_ec_pubkey_serialize(context, out, &key_len, &pub_key, SECP256K1_EC_UNCOMPRESSED);
     return true;
 }
 
-//! Tries extract address from recovered public key
-//! \param [in] public_key: The recovered public key
-//! \return Whether the recovery has succeeded.
-static bool public_key_to_address(uint8_t out[20], const uint8_t public_key[65]) {
+bool silkpre_public_key_to_address(uint8_t out[20], const uint8_t public_key[65]) {
     if (public_key[0] != 4u) {
         return false;
     }
     // Ignore first byte of public key
-    const union ethash_hash256 key_hash = ethash_keccak256(public_key + 1, 64);
-    memcpy(out, &key_hash.bytes[12], 20);
+    uint8_t key_hash[32];
+    silkpre_keccak256(key_hash, public_key + 1, 64);
+    memcpy(out, &key_hash[12], 20);
     return true;
 }
 
 bool silkpre_recover_address(uint8_t out[20], const uint8_t message[32], const uint8_t signature[64], bool odd_y_parity,
-                             secp256k1_context* context) {
+                             const secp256k1_context* context) {
     uint8_t public_key[65];
-    if (!recover(public_key, message, signature, odd_y_parity, context)) {
+    if (!silkpre_recover_public_key(public_key, message, signature, odd_y_parity, context)) {
         return false;
     }
-    return public_key_to_address(out, public_key);
+    return silkpre_public_key_to_address(out, public_key);
 }
 
 // degenerate hash function that just copies the given X value
@@ -82,5 +83,8 @@ bool silkpre_secp256k1_ecdh(
     const secp256k1_pubkey* public_key,
     const uint8_t* private_key) {
 
+    if (!context) {
+        context = silkpre_secp256k1_context();
+    }
     return secp256k1_ecdh(context, output, public_key, private_key, ecdh_hash_function_copy_x, NULL);
 }
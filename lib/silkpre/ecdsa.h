@@ -28,17 +28,36 @@
 extern "C" {
 #endif
 
-enum { SILKPRE_SECP256K1_CONTEXT_FLAGS = (SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY) };
+// Recovery only needs the verification tables; SIGN would also build the generator table
+// (unless it's baked in with SILKPRE_SECP256K1_STATIC_TABLES).
+enum { SILKPRE_SECP256K1_CONTEXT_FLAGS = SECP256K1_CONTEXT_VERIFY };
 
 //! \brief Tries recover the address used for message signing
 //! \param [in] message : the signed message
 //! \param [in] signature : the signature
 //! \param [in] odd_y_parity : whether y parity is odd
-//! \param [in] context: a pointer to an existing secp256k1 context
+//! \param [in] context: a secp256k1 context with VERIFY, or NULL for silkpre_secp256k1_context()
 //! \return Whether the recovery has succeeded
 bool silkpre_recover_address(uint8_t out[20], const uint8_t message[32], const uint8_t signature[64], bool odd_y_parity,
-                             secp256k1_context* context);
+                             const secp256k1_context* context);
 
+//! \brief Tries to recover the public key used for message signing
+//! \param [out] out : the uncompressed public key, 0x04 | x | y
+//! \param [in] message : the signed message
+//! \param [in] signature : the signature
+//! \param [in] odd_y_parity : whether y parity is odd
+//! \param [in] context: a secp256k1 context with VERIFY, or NULL for silkpre_secp256k1_context()
+//! \return Whether the recovery has succeeded
+bool silkpre_recover_public_key(uint8_t out[65], const uint8_t message[32], const uint8_t signature[64],
+                                bool odd_y_parity, const secp256k1_context* context);
+
+//! \brief Derives the address from an uncompressed public key, as returned by silkpre_recover_public_key
+//! \return Whether the key is uncompressed
+bool silkpre_public_key_to_address(uint8_t out[20], const uint8_t public_key[65]);
+
+//! \brief Computes the x coordinate of private_key * public_key
+//! \param [in] context: a secp256k1 context, or NULL for silkpre_secp256k1_context()
+//! \return Whether the private key is valid
 bool silkpre_secp256k1_ecdh(
     const secp256k1_context* context,
     uint8_t* output,
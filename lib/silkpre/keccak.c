@@ -0,0 +1,274 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "keccak.h"
+
+#include <string.h>
+
+#include <silkpre/cpu.h>
+#include <silkpre/dispatch.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SILKPRE_KECCAK_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_SHA3)
+// Only when the compiler targets ARMv8.2 SHA-3 anyway, e.g. Apple silicon
+#define SILKPRE_KECCAK_ARM_SHA3 1
+#include <arm_neon.h>
+#endif
+
+static const uint64_t keccak_rc[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
+    0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
+    0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008,
+};
+
+static inline uint64_t load64(const void* src) {
+    uint64_t w;
+    memcpy(&w, src, sizeof w);
+    return w;
+}
+
+static inline void store64(void* dst, uint64_t w) { memcpy(dst, &w, sizeof w); }
+
+/*
+ * Keccak-f[1600] on lanes A[x + 5y] of type T, written with fused operations that are single instructions
+ * on some CPUs, to be defined along with LOAD/STORE of a lane and XOR:
+ * EOR3(a, b, c) = a ^ b ^ c, RAX1(a, b) = a ^ rol(b, 1), XAR(a, b, n) = rol(a ^ b, n), BCAX(a, b, c) = a ^ (b & ~c).
+ */
+#define KECCAK_F1600(T, st)                                     \
+    do {                                                        \
+        T A[25], B[25], C[5], D[5];                             \
+        for (unsigned i = 0; i < 25; i++) {                     \
+            A[i] = LOAD(st[i]);                                 \
+        }                                                       \
+        for (unsigned r = 0; r < 24; r++) {                     \
+            /* theta */                                         \
+            C[0] = EOR3(EOR3(A[0], A[5], A[10]), A[15], A[20]); \
+            C[1] = EOR3(EOR3(A[1], A[6], A[11]), A[16], A[21]); \
+            C[2] = EOR3(EOR3(A[2], A[7], A[12]), A[17], A[22]); \
+            C[3] = EOR3(EOR3(A[3], A[8], A[13]), A[18], A[23]); \
+            C[4] = EOR3(EOR3(A[4], A[9], A[14]), A[19], A[24]); \
+            D[0] = RAX1(C[4], C[1]);                            \
+            D[1] = RAX1(C[0], C[2]);                            \
+            D[2] = RAX1(C[1], C[3]);                            \
+            D[3] = RAX1(C[2], C[4]);                            \
+            D[4] = RAX1(C[3], C[0]);                            \
+            /* rho and pi */                                    \
+            B[0] = XAR(A[0], D[0], 0);                          \
+            B[10] = XAR(A[1], D[1], 1);                         \
+            B[20] = XAR(A[2], D[2], 62);                        \
+            B[5] = XAR(A[3], D[3], 28);                         \
+            B[15] = XAR(A[4], D[4], 27);                        \
+            B[16] = XAR(A[5], D[0], 36);                        \
+            B[1] = XAR(A[6], D[1], 44);                         \
+            B[11] = XAR(A[7], D[2], 6);                         \
+            B[21] = XAR(A[8], D[3], 55);                        \
+            B[6] = XAR(A[9], D[4], 20);                         \
+            B[7] = XAR(A[10], D[0], 3);                         \
+            B[17] = XAR(A[11], D[1], 10);                       \
+            B[2] = XAR(A[12], D[2], 43);                        \
+            B[12] = XAR(A[13], D[3], 25);                       \
+            B[22] = XAR(A[14], D[4], 39);                       \
+            B[23] = XAR(A[15], D[0], 41);                       \
+            B[8] = XAR(A[16], D[1], 45);                        \
+            B[18] = XAR(A[17], D[2], 15);                       \
+            B[3] = XAR(A[18], D[3], 21);                        \
+            B[13] = XAR(A[19], D[4], 8);                        \
+            B[14] = XAR(A[20], D[0], 18);                       \
+            B[24] = XAR(A[21], D[1], 2);                        \
+            B[9] = XAR(A[22], D[2], 61);                        \
+            B[19] = XAR(A[23], D[3], 56);                       \
+            B[4] = XAR(A[24], D[4], 14);                        \
+            /* chi and iota */                                  \
+            A[0] = BCAX(B[0], B[2], B[1]);                      \
+            A[1] = BCAX(B[1], B[3], B[2]);                      \
+            A[2] = BCAX(B[2], B[4], B[3]);                      \
+            A[3] = BCAX(B[3], B[0], B[4]);                      \
+            A[4] = BCAX(B[4], B[1], B[0]);                      \
+            A[5] = BCAX(B[5], B[7], B[6]);                      \
+            A[6] = BCAX(B[6], B[8], B[7]);                      \
+            A[7] = BCAX(B[7], B[9], B[8]);                      \
+            A[8] = BCAX(B[8], B[5], B[9]);                      \
+            A[9] = BCAX(B[9], B[6], B[5]);                      \
+            A[10] = BCAX(B[10], B[12], B[11]);                  \
+            A[11] = BCAX(B[11], B[13], B[12]);                  \
+            A[12] = BCAX(B[12], B[14], B[13]);                  \
+            A[13] = BCAX(B[13], B[10], B[14]);                  \
+            A[14] = BCAX(B[14], B[11], B[10]);                  \
+            A[15] = BCAX(B[15], B[17], B[16]);                  \
+            A[16] = BCAX(B[16], B[18], B[17]);                  \
+            A[17] = BCAX(B[17], B[19], B[18]);                  \
+            A[18] = BCAX(B[18], B[15], B[19]);                  \
+            A[19] = BCAX(B[19], B[16], B[15]);                  \
+            A[20] = BCAX(B[20], B[22], B[21]);                  \
+            A[21] = BCAX(B[21], B[23], B[22]);                  \
+            A[22] = BCAX(B[22], B[24], B[23]);                  \
+            A[23] = BCAX(B[23], B[20], B[24]);                  \
+            A[24] = BCAX(B[24], B[21], B[20]);                  \
+            A[0] = XOR(A[0], LOAD(keccak_rc[r]));               \
+        }                                                       \
+        for (unsigned i = 0; i < 25; i++) {                     \
+            st[i] = STORE(A[i]);                                \
+        }                                                       \
+    } while (0)
+
+#define ROL64(x, n) (((x) << (n)) | ((x) >> ((64 - (n)) & 63)))
+#define LOAD(x) (x)
+#define STORE(x) (x)
+#define XOR(a, b) ((a) ^ (b))
+#define EOR3(a, b, c) ((a) ^ (b) ^ (c))
+#define RAX1(a, b) ((a) ^ ROL64((b), 1))
+#define XAR(a, b, n) ROL64((a) ^ (b), (n))
+#define BCAX(a, b, c) ((a) ^ ((b) & ~(c)))
+
+static void keccak_f1600_generic(uint64_t st[25]) { KECCAK_F1600(uint64_t, st); }
+
+#if defined(SILKPRE_KECCAK_X86)
+
+// ANDN and RORX take care of chi and rho, which leaves nothing to gain from lane complementing
+__attribute__((target("bmi,bmi2"))) static void keccak_f1600_bmi2(uint64_t st[25]) { KECCAK_F1600(uint64_t, st); }
+
+#endif  // defined(SILKPRE_KECCAK_X86)
+
+#undef ROL64
+#undef LOAD
+#undef STORE
+#undef XOR
+#undef EOR3
+#undef RAX1
+#undef XAR
+#undef BCAX
+
+#if defined(SILKPRE_KECCAK_X86)
+
+// A lane per xmm register: AVX-512VL has 32 of them, VPTERNLOGQ for EOR3 and BCAX, and VPROLQ
+#define LOAD(x) _mm_cvtsi64_si128((long long)(x))
+#define STORE(x) (uint64_t) _mm_cvtsi128_si64(x)
+#define XOR(a, b) _mm_xor_si128((a), (b))
+#define EOR3(a, b, c) _mm_ternarylogic_epi64((a), (b), (c), 0x96)
+#define RAX1(a, b) _mm_xor_si128((a), _mm_rol_epi64((b), 1))
+#define XAR(a, b, n) _mm_rol_epi64(_mm_xor_si128((a), (b)), (n))
+#define BCAX(a, b, c) _mm_ternarylogic_epi64((a), (b), (c), 0xb4)
+
+__attribute__((target("avx512f,avx512vl"))) static void keccak_f1600_avx512(uint64_t st[25]) {
+    KECCAK_F1600(__m128i, st);
+}
+
+#undef LOAD
+#undef STORE
+#undef XOR
+#undef EOR3
+#undef RAX1
+#undef XAR
+#undef BCAX
+
+#elif defined(SILKPRE_KECCAK_ARM_SHA3)
+
+// A lane per vector register, of which there are 32, and an instruction for each fused operation
+#define LOAD(x) vdupq_n_u64(x)
+#define STORE(x) vgetq_lane_u64((x), 0)
+#define XOR(a, b) veorq_u64((a), (b))
+#define EOR3(a, b, c) veor3q_u64((a), (b), (c))
+#define RAX1(a, b) vrax1q_u64((a), (b))
+#define XAR(a, b, n) vxarq_u64((a), (b), (64 - (n)) & 63)
+#define BCAX(a, b, c) vbcaxq_u64((a), (b), (c))
+
+static void keccak_f1600_arm_sha3(uint64_t st[25]) { KECCAK_F1600(uint64x2_t, st); }
+
+#undef LOAD
+#undef STORE
+#undef XOR
+#undef EOR3
+#undef RAX1
+#undef XAR
+#undef BCAX
+
+#endif  // defined(SILKPRE_KECCAK_X86), defined(SILKPRE_KECCAK_ARM_SHA3)
+
+#undef KECCAK_F1600
+
+struct keccak_kernel {
+    void (*fn)(uint64_t st[25]);
+    const char* name;
+};
+
+static struct keccak_kernel select_keccak_kernel(uint32_t features) {
+#if defined(SILKPRE_KECCAK_X86)
+    if (features & SILKPRE_CPU_AVX512) {
+        return (struct keccak_kernel){keccak_f1600_avx512, "x86_avx512"};
+    }
+    if (features & SILKPRE_CPU_BMI2) {
+        return (struct keccak_kernel){keccak_f1600_bmi2, "x86_bmi2"};
+    }
+#elif defined(SILKPRE_KECCAK_ARM_SHA3)
+    if (features & SILKPRE_CPU_ARM_SHA3) {
+        return (struct keccak_kernel){keccak_f1600_arm_sha3, "arm_sha3"};
+    }
+#endif
+    (void)features;
+    return (struct keccak_kernel){keccak_f1600_generic, "generic"};
+}
+
+const char* silkpre_keccak_kernel(uint32_t features) { return select_keccak_kernel(features).name; }
+
+void silkpre_keccak_f1600(uint64_t state[25]) { select_keccak_kernel(silkpre_cpu_features()).fn(state); }
+
+void silkpre_keccak256_init(SilkpreKeccak256* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+static void xor_byte(uint64_t state[25], size_t i, uint8_t b) { state[i / 8] ^= (uint64_t)b << (8 * (i % 8)); }
+
+void silkpre_keccak256_update(SilkpreKeccak256* ctx, const uint8_t* input, size_t len) {
+    void (*const permute)(uint64_t st[25]) = select_keccak_kernel(silkpre_cpu_features()).fn;
+
+    // Top up a partially absorbed block
+    for (; ctx->offset && len; ++input, --len) {
+        xor_byte(ctx->state, ctx->offset, *input);
+        if (++ctx->offset == SILKPRE_KECCAK256_RATE) {
+            permute(ctx->state);
+            ctx->offset = 0;
+        }
+    }
+
+    for (; len >= SILKPRE_KECCAK256_RATE; input += SILKPRE_KECCAK256_RATE, len -= SILKPRE_KECCAK256_RATE) {
+        for (size_t i = 0; i < SILKPRE_KECCAK256_RATE / 8; i++) {
+            ctx->state[i] ^= load64(input + 8 * i);
+        }
+        permute(ctx->state);
+    }
+
+    for (; len; ++input, --len) {
+        xor_byte(ctx->state, ctx->offset++, *input);
+    }
+}
+
+void silkpre_keccak256_final(SilkpreKeccak256* ctx, uint8_t hash[32]) {
+    xor_byte(ctx->state, ctx->offset, 0x01);
+    xor_byte(ctx->state, SILKPRE_KECCAK256_RATE - 1, 0x80);
+    silkpre_keccak_f1600(ctx->state);
+    for (size_t i = 0; i < 4; i++) {
+        store64(hash + 8 * i, ctx->state[i]);
+    }
+}
+
+void silkpre_keccak256(uint8_t hash[32], const uint8_t* input, size_t len) {
+    SilkpreKeccak256 ctx;
+    silkpre_keccak256_init(&ctx);
+    silkpre_keccak256_update(&ctx, input, len);
+    silkpre_keccak256_final(&ctx, hash);
+}
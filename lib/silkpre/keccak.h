@@ -0,0 +1,52 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_KECCAK_H_
+#define SILKPRE_KECCAK_H_
+
+// Keccak-256 as used by Ethereum, i.e. with the original padding rather than the one of FIPS 202 SHA3-256
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum { SILKPRE_KECCAK256_RATE = 136 };
+
+typedef struct SilkpreKeccak256 {
+    uint64_t state[25];
+    size_t offset;  // bytes absorbed into the current block
+} SilkpreKeccak256;
+
+void silkpre_keccak256(uint8_t hash[32], const uint8_t* input, size_t len);
+
+void silkpre_keccak256_init(SilkpreKeccak256* ctx);
+
+void silkpre_keccak256_update(SilkpreKeccak256* ctx, const uint8_t* input, size_t len);
+
+//! \brief Writes the hash of everything absorbed so far; ctx has to be initialized again to be reused
+void silkpre_keccak256_final(SilkpreKeccak256* ctx, uint8_t hash[32]);
+
+//! \brief The Keccak-f[1600] permutation of the kernel selected for silkpre_cpu_features()
+void silkpre_keccak_f1600(uint64_t state[25]);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_KECCAK_H_
@@ -0,0 +1,132 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_LRU_CACHE_HPP_
+#define SILKPRE_LRU_CACHE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace silkpre {
+
+struct LruCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t insertions{0};
+    uint64_t evictions{0};
+};
+
+// Thread-safe LRU cache split into independently locked shards.
+// Every entry has a weight (1 by default); each shard evicts its least recently used
+// entries once the total weight exceeds its share of the capacity.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLruCache {
+  public:
+    ShardedLruCache(size_t capacity, size_t num_shards)
+        : num_shards_{num_shards ? num_shards : 1}, shards_{new Shard[num_shards_]} {
+        for (size_t i{0}; i < num_shards_; ++i) {
+            shards_[i].capacity = capacity / num_shards_;
+        }
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    std::optional<Value> get(const Key& key) {
+        Shard& shard{shard_for(key)};
+        std::lock_guard lock{shard.mutex};
+        const auto it{shard.index.find(key)};
+        if (it == shard.index.end()) {
+            ++shard.stats.misses;
+            return std::nullopt;
+        }
+        ++shard.stats.hits;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->value;
+    }
+
+    void put(const Key& key, Value value, size_t weight = 1) {
+        Shard& shard{shard_for(key)};
+        std::lock_guard lock{shard.mutex};
+        if (weight > shard.capacity) {
+            return;
+        }
+        if (const auto it{shard.index.find(key)}; it != shard.index.end()) {
+            shard.weight -= it->second->weight;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+        while (shard.weight + weight > shard.capacity) {
+            const Entry& victim{shard.lru.back()};
+            shard.weight -= victim.weight;
+            shard.index.erase(victim.key);
+            shard.lru.pop_back();
+            ++shard.stats.evictions;
+        }
+        shard.lru.push_front(Entry{key, std::move(value), weight});
+        shard.index.emplace(key, shard.lru.begin());
+        shard.weight += weight;
+        ++shard.stats.insertions;
+    }
+
+    LruCacheStats stats() const {
+        LruCacheStats total;
+        for (size_t i{0}; i < num_shards_; ++i) {
+            std::lock_guard lock{shards_[i].mutex};
+            total.hits += shards_[i].stats.hits;
+            total.misses += shards_[i].stats.misses;
+            total.insertions += shards_[i].stats.insertions;
+            total.evictions += shards_[i].stats.evictions;
+        }
+        return total;
+    }
+
+  private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t weight;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // most recently used first
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+        size_t capacity{0};
+        size_t weight{0};
+        LruCacheStats stats;
+    };
+
+    Shard& shard_for(const Key& key) const noexcept {
+        // Fibonacci hashing; the high bits are decorrelated from the bucket index of the per-shard map
+        const uint64_t h{static_cast<uint64_t>(Hash{}(key)) * 0x9e3779b97f4a7c15};
+        return shards_[(h >> 32) % num_shards_];
+    }
+
+    size_t num_shards_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace silkpre
+
+#endif  // SILKPRE_LRU_CACHE_HPP_
@@ -0,0 +1,184 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "montgomery.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include <silkpre/lru_cache.hpp>
+
+static_assert(GMP_NAIL_BITS == 0);
+
+namespace {
+
+constexpr size_t kCacheCapacity{1 << 20};  // bytes
+constexpr size_t kCacheShards{16};
+constexpr size_t kEntryOverhead{160};
+
+struct LimbsHash {
+    size_t operator()(const std::vector<mp_limb_t>& limbs) const noexcept {
+        uint64_t h{limbs.size()};
+        for (const mp_limb_t limb : limbs) {
+            h = (h ^ static_cast<uint64_t>(limb)) * 0x100000001b3;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+using ContextCache = silkpre::ShardedLruCache<std::vector<mp_limb_t>,
+                                              std::shared_ptr<const silkpre::MontgomeryContext>, LimbsHash>;
+
+ContextCache& context_cache() {
+    static ContextCache* cache{new ContextCache{kCacheCapacity, kCacheShards}};
+    return *cache;
+}
+
+// Size of the window for a left-to-right k-ary exponentiation: the 2^k - 1 multiplications building
+// the table against the bits / k multiplications of the scan
+unsigned window_bits(size_t exponent_bits) noexcept {
+    if (exponent_bits <= 24) {
+        return 1;
+    } else if (exponent_bits <= 80) {
+        return 3;
+    } else if (exponent_bits <= 240) {
+        return 4;
+    } else if (exponent_bits <= 672) {
+        return 5;
+    }
+    return 6;
+}
+
+std::vector<mp_limb_t> export_limbs(mpz_srcptr x, size_t n) {
+    std::vector<mp_limb_t> limbs(n);
+    mpz_export(limbs.data(), nullptr, /*order=*/-1, sizeof(mp_limb_t), /*endian=*/0, /*nails=*/0, x);
+    return limbs;
+}
+
+}  // namespace
+
+namespace silkpre {
+
+MontgomeryContext::MontgomeryContext(const mp_limb_t* modulus, size_t n) : modulus_(modulus, modulus + n), r2_(n) {
+    // Newton's iteration doubles the number of correct low bits, starting from 3 for any odd N
+    mp_limb_t inv{modulus[0]};
+    for (int bits{3}; bits < GMP_NUMB_BITS; bits *= 2) {
+        inv *= 2 - modulus[0] * inv;
+    }
+    inv_ = -inv;
+
+    std::vector<mp_limb_t> r4(2 * n + 1);  // R^2
+    r4[2 * n] = 1;
+    std::vector<mp_limb_t> quotient(n + 2);
+    mpn_tdiv_qr(quotient.data(), r2_.data(), 0, r4.data(), static_cast<mp_size_t>(r4.size()), modulus,
+                static_cast<mp_size_t>(n));
+}
+
+void MontgomeryContext::reduce(mp_limb_t* r, mp_limb_t* t) const noexcept {
+    const mp_size_t n{static_cast<mp_size_t>(modulus_.size())};
+    const mp_limb_t* m{modulus_.data()};
+    // Zeroes the low limbs one by one, parking each carry in the limb just cleared
+    for (mp_size_t i{0}; i < n; ++i) {
+        t[i] = mpn_addmul_1(t + i, m, n, t[i] * inv_);
+    }
+    const mp_limb_t carry{mpn_add_n(r, t + n, t, n)};
+    if (carry || mpn_cmp(r, m, n) >= 0) {
+        mpn_sub_n(r, r, m, n);
+    }
+}
+
+void MontgomeryContext::mul(mp_limb_t* r, const mp_limb_t* a, const mp_limb_t* b, mp_limb_t* t) const noexcept {
+    const mp_size_t n{static_cast<mp_size_t>(modulus_.size())};
+    if (a == b) {
+        mpn_sqr(t, a, n);
+    } else {
+        mpn_mul_n(t, a, b, n);
+    }
+    reduce(r, t);
+}
+
+bool MontgomeryContext::powm(mpz_ptr result, mpz_srcptr base, mpz_srcptr exponent, bool (*expired)()) const {
+    const size_t n{modulus_.size()};
+    const size_t bits{mpz_sgn(exponent) ? mpz_sizeinbase(exponent, 2) : 0};
+    const unsigned k{window_bits(bits)};
+
+    // table of base^i in Montgomery form for 0 < i < 2^k (slot 0 unused) | accumulator | 2n of scratch
+    std::vector<mp_limb_t> mem(((size_t{1} << k) + 3) * n);
+    mp_limb_t* table{mem.data()};
+    mp_limb_t* acc{table + (n << k)};
+    mp_limb_t* t{acc + n};
+
+    mpz_export(acc, nullptr, /*order=*/-1, sizeof(mp_limb_t), /*endian=*/0, /*nails=*/0, base);
+    mul(table + n, acc, r2_.data(), t);
+    for (size_t i{2}; i < (size_t{1} << k); ++i) {
+        mul(table + i * n, table + (i - 1) * n, table + n, t);
+    }
+
+    bool one{true};  // acc holds 1, which is neither squared nor multiplied
+    for (size_t pos{(bits + k - 1) / k * k}; pos > 0; pos -= k) {
+        if (expired && expired()) {
+            return false;
+        }
+        size_t digit{0};
+        for (size_t j{1}; j <= k; ++j) {
+            digit = (digit << 1) | static_cast<size_t>(mpz_tstbit(exponent, pos - j));
+            if (!one) {
+                mul(acc, acc, acc, t);
+            }
+        }
+        if (digit && one) {
+            std::copy_n(table + digit * n, n, acc);
+            one = false;
+        } else if (digit) {
+            mul(acc, acc, table + digit * n, t);
+        }
+    }
+
+    if (one) {
+        // x^0 = 1, except that everything is 0 modulo 1
+        mpz_set_ui(result, n == 1 && modulus_[0] == 1 ? 0 : 1);
+        return true;
+    }
+
+    // out of the Montgomery form
+    std::copy_n(acc, n, t);
+    std::fill_n(t + n, n, 0);
+    reduce(acc, t);
+    mpz_import(result, n, /*order=*/-1, sizeof(mp_limb_t), /*endian=*/0, /*nails=*/0, acc);
+    return true;
+}
+
+std::shared_ptr<const MontgomeryContext> montgomery_context(mpz_srcptr modulus) {
+    std::vector<mp_limb_t> key{export_limbs(modulus, mpz_size(modulus))};
+    if (auto hit{context_cache().get(key)}) {
+        return std::move(*hit);
+    }
+    auto context{std::make_shared<const MontgomeryContext>(key.data(), key.size())};
+    const size_t weight{kEntryOverhead + key.size() * sizeof(mp_limb_t) + context->weight()};
+    context_cache().put(std::move(key), context, weight);
+    return context;
+}
+
+}  // namespace silkpre
+
+void silkpre_montgomery_cache_stats(SilkpreCacheStats* stats) {
+    const silkpre::LruCacheStats s{context_cache().stats()};
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->insertions = s.insertions;
+    stats->evictions = s.evictions;
+}
@@ -0,0 +1,36 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_MONTGOMERY_H_
+#define SILKPRE_MONTGOMERY_H_
+
+// Cache of the Montgomery constants of odd modexp moduli, so that contracts verifying
+// RSA signatures against the same keys skip the per-modulus setup.
+
+#include <silkpre/cache.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! \brief Counters of the process-wide modulus cache used by the modexp precompile
+void silkpre_montgomery_cache_stats(SilkpreCacheStats* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_MONTGOMERY_H_
@@ -0,0 +1,60 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_MONTGOMERY_HPP_
+#define SILKPRE_MONTGOMERY_HPP_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include <gmp.h>
+
+#include <silkpre/montgomery.h>
+
+namespace silkpre {
+
+// Montgomery arithmetic modulo an odd N of n limbs with R = 2^(GMP_NUMB_BITS * n)
+class MontgomeryContext {
+  public:
+    MontgomeryContext(const mp_limb_t* modulus, size_t n);
+
+    // result = base^exponent mod N for base < N.
+    // Polls expired, if any, after each window of the exponent and returns false once it returns true.
+    bool powm(mpz_ptr result, mpz_srcptr base, mpz_srcptr exponent, bool (*expired)() = nullptr) const;
+
+    // Bytes held by the context
+    size_t weight() const noexcept { return (modulus_.size() + r2_.size()) * sizeof(mp_limb_t); }
+
+  private:
+    // r = a * b / R mod N for a, b < N; t is scratch space of 2n limbs
+    void mul(mp_limb_t* r, const mp_limb_t* a, const mp_limb_t* b, mp_limb_t* t) const noexcept;
+
+    // r = t / R mod N for t < N * R; t (2n limbs) is clobbered
+    void reduce(mp_limb_t* r, mp_limb_t* t) const noexcept;
+
+    std::vector<mp_limb_t> modulus_;
+    std::vector<mp_limb_t> r2_;  // R^2 mod N
+    mp_limb_t inv_;              // -N^-1 mod 2^GMP_NUMB_BITS
+};
+
+// Context of an odd positive modulus, from the process-wide cache
+std::shared_ptr<const MontgomeryContext> montgomery_context(mpz_srcptr modulus);
+
+}  // namespace silkpre
+
+#endif  // SILKPRE_MONTGOMERY_HPP_
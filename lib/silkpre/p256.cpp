@@ -0,0 +1,589 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "p256.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <silkpre/cpu.h>
+#include <silkpre/dispatch.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Limb loops are short and of fixed length; make sure they are unrolled at -O2 too.
+#if defined(__clang__)
+#define SILKPRE_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define SILKPRE_UNROLL _Pragma("GCC unroll 4")
+#else
+#define SILKPRE_UNROLL
+#endif
+
+// Field and scalar arithmetic use 4x64-bit limbs (least significant first) in Montgomery form.
+// Points are kept in Jacobian coordinates; curve formulas are from
+// https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html
+// Verification is variable-time: all of its inputs are public.
+
+namespace {
+
+using Limbs = std::array<uint64_t, 4>;
+
+struct Modulus {
+    Limbs m;
+    uint64_t m0inv;  // -m^-1 mod 2^64
+    Limbs r2;        // 2^512 mod m
+};
+
+// p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+constexpr Modulus kP{
+    {0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001},
+    0x0000000000000001,
+    {0x0000000000000003, 0xfffffffbffffffff, 0xfffffffffffffffe, 0x00000004fffffffd},
+};
+
+// Order of the base point
+constexpr Modulus kN{
+    {0xf3b9cac2fc632551, 0xbce6faada7179e84, 0xffffffffffffffff, 0xffffffff00000000},
+    0xccd1c8aaee00bc4f,
+    {0x83244c95be79eea2, 0x4699799c49bd6fa6, 0x2845b2392b6bec59, 0x66e12d94f3d95620},
+};
+
+constexpr Limbs kB{0x3bce3c3e27d2604b, 0x651d06b0cc53b0f6, 0xb3ebbd55769886bc, 0x5ac635d8aa3a93e7};
+constexpr Limbs kGx{0xf4a13945d898c296, 0x77037d812deb33a0, 0xf8bce6e563a440f2, 0x6b17d1f2e12c4247};
+constexpr Limbs kGy{0xcbb6406837bf51f5, 0x2bce33576b315ece, 0x8ee7eb4a7c0f9e16, 0x4fe342e2fe1a7f9b};
+
+// Window widths of the wNAF recodings of u1 (fixed base G) and u2 (variable base Q)
+constexpr unsigned kWindowG{8};
+constexpr unsigned kWindowQ{5};
+constexpr size_t kTableSizeG{size_t{1} << (kWindowG - 2)};
+constexpr size_t kTableSizeQ{size_t{1} << (kWindowQ - 2)};
+constexpr size_t kMaxNafLength{257};
+
+// Returns a * b + c + carry and sets carry to the high word.
+inline uint64_t mac(uint64_t a, uint64_t b, uint64_t c, uint64_t& carry) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    uint64_t hi;
+    uint64_t lo{_umul128(a, b, &hi)};
+    hi += _addcarry_u64(0, lo, c, &lo);
+    hi += _addcarry_u64(0, lo, carry, &lo);
+    carry = hi;
+    return lo;
+#else
+    const unsigned __int128 t{static_cast<unsigned __int128>(a) * b + c + carry};
+    carry = static_cast<uint64_t>(t >> 64);
+    return static_cast<uint64_t>(t);
+#endif
+}
+
+// Returns a + b + carry and sets carry to the carry out.
+inline uint64_t adc(uint64_t a, uint64_t b, uint64_t& carry) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    uint64_t r;
+    carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &r);
+    return r;
+#else
+    const unsigned __int128 t{static_cast<unsigned __int128>(a) + b + carry};
+    carry = static_cast<uint64_t>(t >> 64);
+    return static_cast<uint64_t>(t);
+#endif
+}
+
+// Returns a - b - borrow and sets borrow to the borrow out.
+inline uint64_t sbb(uint64_t a, uint64_t b, uint64_t& borrow) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    uint64_t r;
+    borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &r);
+    return r;
+#else
+    const unsigned __int128 t{static_cast<unsigned __int128>(a) - b - borrow};
+    borrow = static_cast<uint64_t>(t >> 64) & 1;
+    return static_cast<uint64_t>(t);
+#endif
+}
+
+inline uint64_t add_raw(Limbs& r, const Limbs& a, const Limbs& b) noexcept {
+    uint64_t carry{0};
+    SILKPRE_UNROLL
+    for (size_t i{0}; i < 4; ++i) {
+        r[i] = adc(a[i], b[i], carry);
+    }
+    return carry;
+}
+
+inline uint64_t sub_raw(Limbs& r, const Limbs& a, const Limbs& b) noexcept {
+    uint64_t borrow{0};
+    SILKPRE_UNROLL
+    for (size_t i{0}; i < 4; ++i) {
+        r[i] = sbb(a[i], b[i], borrow);
+    }
+    return borrow;
+}
+
+inline bool is_zero(const Limbs& a) noexcept { return (a[0] | a[1] | a[2] | a[3]) == 0; }
+
+inline bool less_than(const Limbs& a, const Limbs& b) noexcept {
+    for (size_t i{4}; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i];
+        }
+    }
+    return false;
+}
+
+inline Limbs mod_add(const Limbs& a, const Limbs& b, const Modulus& mod) noexcept {
+    Limbs r;
+    if (add_raw(r, a, b) || !less_than(r, mod.m)) {
+        sub_raw(r, r, mod.m);
+    }
+    return r;
+}
+
+inline Limbs mod_sub(const Limbs& a, const Limbs& b, const Modulus& mod) noexcept {
+    Limbs r;
+    if (sub_raw(r, a, b)) {
+        add_raw(r, r, mod.m);
+    }
+    return r;
+}
+
+// Montgomery multiplication a * b / 2^256 mod m (CIOS method); requires a, b < m.
+inline Limbs mont_mul(const Limbs& a, const Limbs& b, const Modulus& mod) noexcept {
+    uint64_t t0{0}, t1{0}, t2{0}, t3{0}, t4{0};
+    SILKPRE_UNROLL
+    for (size_t i{0}; i < 4; ++i) {
+        uint64_t carry{0};
+        t0 = mac(a[0], b[i], t0, carry);
+        t1 = mac(a[1], b[i], t1, carry);
+        t2 = mac(a[2], b[i], t2, carry);
+        t3 = mac(a[3], b[i], t3, carry);
+        uint64_t t5{0};
+        t4 = adc(t4, carry, t5);
+
+        const uint64_t q{t0 * mod.m0inv};
+        carry = 0;
+        mac(q, mod.m[0], t0, carry);  // the low word vanishes by construction of q
+        t0 = mac(q, mod.m[1], t1, carry);
+        t1 = mac(q, mod.m[2], t2, carry);
+        t2 = mac(q, mod.m[3], t3, carry);
+        uint64_t c{0};
+        t3 = adc(t4, carry, c);
+        t4 = t5 + c;
+    }
+
+    Limbs r{t0, t1, t2, t3};
+    if (t4 || !less_than(r, mod.m)) {
+        sub_raw(r, r, mod.m);
+    }
+    return r;
+}
+
+inline Limbs to_mont(const Limbs& a, const Modulus& mod) noexcept { return mont_mul(a, mod.r2, mod); }
+
+// a^e in the Montgomery domain with a 4-bit fixed window; the exponent is public.
+Limbs mont_pow(const Limbs& a, const Limbs& e, const Modulus& mod) noexcept {
+    Limbs table[16];
+    table[0] = to_mont({1, 0, 0, 0}, mod);
+    for (size_t i{1}; i < 16; ++i) {
+        table[i] = mont_mul(table[i - 1], a, mod);
+    }
+
+    Limbs r{table[0]};
+    for (size_t i{64}; i-- > 0;) {
+        for (size_t j{0}; j < 4; ++j) {
+            r = mont_mul(r, r, mod);
+        }
+        const unsigned nibble{static_cast<unsigned>(e[i / 16] >> (4 * (i % 16))) & 0xf};
+        if (nibble) {
+            r = mont_mul(r, table[nibble], mod);
+        }
+    }
+    return r;
+}
+
+// Fermat inversion in the Montgomery domain; a must be non-zero.
+inline Limbs mont_inv(const Limbs& a, const Modulus& mod) noexcept {
+    Limbs e{mod.m};
+    e[0] -= 2;
+    return mont_pow(a, e, mod);
+}
+
+Limbs load_be(const uint8_t bytes[32]) noexcept {
+    Limbs r;
+    for (size_t i{0}; i < 4; ++i) {
+        uint64_t x{0};
+        for (size_t j{0}; j < 8; ++j) {
+            x = (x << 8) | bytes[(3 - i) * 8 + j];
+        }
+        r[i] = x;
+    }
+    return r;
+}
+
+inline Limbs fmul(const Limbs& a, const Limbs& b) noexcept { return mont_mul(a, b, kP); }
+inline Limbs fsqr(const Limbs& a) noexcept { return mont_mul(a, a, kP); }
+inline Limbs fadd(const Limbs& a, const Limbs& b) noexcept { return mod_add(a, b, kP); }
+inline Limbs fsub(const Limbs& a, const Limbs& b) noexcept { return mod_sub(a, b, kP); }
+inline Limbs fneg(const Limbs& a) noexcept { return fsub({0, 0, 0, 0}, a); }
+
+struct Affine {
+    Limbs x;
+    Limbs y;
+};
+
+// The point at infinity has z = 0.
+struct Jacobian {
+    Limbs x;
+    Limbs y;
+    Limbs z;
+};
+
+// dbl-2001-b, a = -3
+Jacobian dbl(const Jacobian& p) noexcept {
+    if (is_zero(p.z)) {
+        return p;
+    }
+    const Limbs delta{fsqr(p.z)};
+    const Limbs gamma{fsqr(p.y)};
+    const Limbs beta{fmul(p.x, gamma)};
+    Limbs alpha{fmul(fsub(p.x, delta), fadd(p.x, delta))};
+    alpha = fadd(alpha, fadd(alpha, alpha));
+    const Limbs beta4{fadd(fadd(beta, beta), fadd(beta, beta))};
+    const Limbs beta8{fadd(beta4, beta4)};
+
+    Jacobian r;
+    r.x = fsub(fsqr(alpha), beta8);
+    r.z = fsub(fsub(fsqr(fadd(p.y, p.z)), gamma), delta);
+    Limbs gamma8{fsqr(gamma)};
+    gamma8 = fadd(gamma8, gamma8);
+    gamma8 = fadd(gamma8, gamma8);
+    gamma8 = fadd(gamma8, gamma8);
+    r.y = fsub(fmul(alpha, fsub(beta4, r.x)), gamma8);
+    return r;
+}
+
+// madd-2007-bl
+Jacobian add_mixed(const Jacobian& p, const Affine& q, const Limbs& one) noexcept {
+    if (is_zero(p.z)) {
+        return {q.x, q.y, one};
+    }
+    const Limbs z1z1{fsqr(p.z)};
+    const Limbs u2{fmul(q.x, z1z1)};
+    const Limbs s2{fmul(q.y, fmul(p.z, z1z1))};
+    const Limbs h{fsub(u2, p.x)};
+    Limbs r{fsub(s2, p.y)};
+    if (is_zero(h)) {
+        return is_zero(r) ? dbl(p) : Jacobian{};
+    }
+    const Limbs hh{fsqr(h)};
+    const Limbs i{fadd(fadd(hh, hh), fadd(hh, hh))};
+    const Limbs j{fmul(h, i)};
+    r = fadd(r, r);
+    const Limbs v{fmul(p.x, i)};
+
+    Jacobian res;
+    res.x = fsub(fsub(fsqr(r), j), fadd(v, v));
+    res.y = fsub(fmul(r, fsub(v, res.x)), fmul(fadd(p.y, p.y), j));
+    res.z = fsub(fsub(fsqr(fadd(p.z, h)), z1z1), hh);
+    return res;
+}
+
+// add-2007-bl
+Jacobian add(const Jacobian& p, const Jacobian& q) noexcept {
+    if (is_zero(p.z)) {
+        return q;
+    }
+    if (is_zero(q.z)) {
+        return p;
+    }
+    const Limbs z1z1{fsqr(p.z)};
+    const Limbs z2z2{fsqr(q.z)};
+    const Limbs u1{fmul(p.x, z2z2)};
+    const Limbs u2{fmul(q.x, z1z1)};
+    const Limbs s1{fmul(p.y, fmul(q.z, z2z2))};
+    const Limbs s2{fmul(q.y, fmul(p.z, z1z1))};
+    const Limbs h{fsub(u2, u1)};
+    Limbs r{fsub(s2, s1)};
+    if (is_zero(h)) {
+        return is_zero(r) ? dbl(p) : Jacobian{};
+    }
+    const Limbs i{fsqr(fadd(h, h))};
+    const Limbs j{fmul(h, i)};
+    r = fadd(r, r);
+    const Limbs v{fmul(u1, i)};
+
+    Jacobian res;
+    res.x = fsub(fsub(fsqr(r), j), fadd(v, v));
+    res.y = fsub(fmul(r, fsub(v, res.x)), fmul(fadd(s1, s1), j));
+    res.z = fmul(fsub(fsub(fsqr(fadd(p.z, q.z)), z1z1), z2z2), h);
+    return res;
+}
+
+// Width-w non-adjacent form; digits[i] is the coefficient of 2^i.
+// Returns the number of digits, at most kMaxNafLength for k < 2^256.
+size_t wnaf(int digits[kMaxNafLength], const Limbs& k, unsigned w) noexcept {
+    uint64_t s[5]{k[0], k[1], k[2], k[3], 0};
+    size_t len{0};
+    while (s[0] | s[1] | s[2] | s[3] | s[4]) {
+        int d{0};
+        if (s[0] & 1) {
+            d = static_cast<int>(s[0] & ((uint64_t{1} << w) - 1));
+            if (d >= (1 << (w - 1))) {
+                d -= 1 << w;
+            }
+            // s -= d
+            if (d > 0) {
+                uint64_t borrow{0};
+                s[0] = sbb(s[0], static_cast<uint64_t>(d), borrow);
+                for (size_t i{1}; i < 5; ++i) {
+                    s[i] = sbb(s[i], 0, borrow);
+                }
+            } else {
+                uint64_t carry{0};
+                s[0] = adc(s[0], static_cast<uint64_t>(-d), carry);
+                for (size_t i{1}; i < 5; ++i) {
+                    s[i] = adc(s[i], 0, carry);
+                }
+            }
+        }
+        digits[len++] = d;
+        for (size_t i{0}; i < 4; ++i) {
+            s[i] = (s[i] >> 1) | (s[i + 1] << 63);
+        }
+        s[4] >>= 1;
+    }
+    return len;
+}
+
+struct Context {
+    Limbs one;  // 1 in the Montgomery domain of p
+    Limbs b;
+    Affine g[kTableSizeG];  // odd multiples G, 3G, 5G, ...
+};
+
+Context make_context() noexcept {
+    Context ctx;
+    ctx.one = to_mont({1, 0, 0, 0}, kP);
+    ctx.b = to_mont(kB, kP);
+
+    Jacobian table[kTableSizeG];
+    table[0] = {to_mont(kGx, kP), to_mont(kGy, kP), ctx.one};
+    const Jacobian g2{dbl(table[0])};
+    for (size_t i{1}; i < kTableSizeG; ++i) {
+        table[i] = add(table[i - 1], g2);
+    }
+    for (size_t i{0}; i < kTableSizeG; ++i) {
+        const Limbs z_inv{mont_inv(table[i].z, kP)};
+        const Limbs z_inv2{fsqr(z_inv)};
+        ctx.g[i].x = fmul(table[i].x, z_inv2);
+        ctx.g[i].y = fmul(table[i].y, fmul(z_inv2, z_inv));
+    }
+    return ctx;
+}
+
+const Context& context() noexcept {
+    // magic static
+    static const Context ctx{make_context()};
+    return ctx;
+}
+
+// u1·G + u2·Q with interleaved wNAF (Shamir's trick), sharing the doublings between both scalars.
+Jacobian double_mul(const Limbs& u1, const Limbs& u2, const Jacobian& q, const Context& ctx) noexcept {
+    Jacobian q_table[kTableSizeQ];
+    q_table[0] = q;
+    const Jacobian q2{dbl(q)};
+    for (size_t i{1}; i < kTableSizeQ; ++i) {
+        q_table[i] = add(q_table[i - 1], q2);
+    }
+
+    int naf1[kMaxNafLength]{};
+    int naf2[kMaxNafLength]{};
+    const size_t len1{wnaf(naf1, u1, kWindowG)};
+    const size_t len2{wnaf(naf2, u2, kWindowQ)};
+
+    Jacobian r{};
+    for (size_t i{len1 > len2 ? len1 : len2}; i-- > 0;) {
+        r = dbl(r);
+        if (const int d{naf1[i]}; d > 0) {
+            r = add_mixed(r, ctx.g[(d - 1) / 2], ctx.one);
+        } else if (d < 0) {
+            const Affine& p{ctx.g[(-d - 1) / 2]};
+            r = add_mixed(r, {p.x, fneg(p.y)}, ctx.one);
+        }
+        if (const int d{naf2[i]}; d > 0) {
+            r = add(r, q_table[(d - 1) / 2]);
+        } else if (d < 0) {
+            const Jacobian& p{q_table[(-d - 1) / 2]};
+            r = add(r, {p.x, fneg(p.y), p.z});
+        }
+    }
+    return r;
+}
+
+struct Signature {
+    Limbs e;
+    Limbs r;
+    Limbs s;
+    Limbs qx;
+    Limbs qy;
+};
+
+// Range checks that do not involve curve arithmetic.
+bool parse(Signature& sig, const uint8_t input[SILKPRE_P256_VERIFY_INPUT_SIZE]) noexcept {
+    sig.e = load_be(input);
+    sig.r = load_be(input + 32);
+    sig.s = load_be(input + 64);
+    sig.qx = load_be(input + 96);
+    sig.qy = load_be(input + 128);
+
+    if (is_zero(sig.r) || !less_than(sig.r, kN.m) || is_zero(sig.s) || !less_than(sig.s, kN.m)) {
+        return false;
+    }
+    if (!less_than(sig.qx, kP.m) || !less_than(sig.qy, kP.m)) {
+        return false;
+    }
+    if (!less_than(sig.e, kN.m)) {
+        sub_raw(sig.e, sig.e, kN.m);
+    }
+    return true;
+}
+
+// s_inv is s^-1 in the Montgomery domain of n.
+bool verify(const Signature& sig, const Limbs& s_inv) noexcept {
+    const Context& ctx{context()};
+
+    const Limbs x{to_mont(sig.qx, kP)};
+    const Limbs y{to_mont(sig.qy, kP)};
+    // y^2 = x^3 - 3x + b; this also rejects (0, 0)
+    const Limbs rhs{fadd(fsub(fmul(fsqr(x), x), fadd(fadd(x, x), x)), ctx.b)};
+    if (fsqr(y) != rhs) {
+        return false;
+    }
+
+    // Montgomery multiplication by s^-1·2^256 yields plain u1 = e/s and u2 = r/s
+    const Limbs u1{mont_mul(sig.e, s_inv, kN)};
+    const Limbs u2{mont_mul(sig.r, s_inv, kN)};
+
+    const Jacobian p{double_mul(u1, u2, {x, y, ctx.one}, ctx)};
+    if (is_zero(p.z)) {
+        return false;
+    }
+
+    // Check x(P) mod n == r without an inversion: x(P) = X/Z^2 is either r or r + n.
+    const Limbs z2{fsqr(p.z)};
+    if (fmul(to_mont(sig.r, kP), z2) == p.x) {
+        return true;
+    }
+    Limbs rn;
+    if (add_raw(rn, sig.r, kN.m) || !less_than(rn, kP.m)) {
+        return false;
+    }
+    return fmul(to_mont(rn, kP), z2) == p.x;
+}
+
+// Whole-verification clones, so that the field arithmetic is compiled for the target
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SILKPRE_P256_X86 1
+#define SILKPRE_FLATTEN __attribute__((flatten))
+#else
+#define SILKPRE_FLATTEN
+#endif
+
+struct Kernel {
+    bool (*verify)(const Signature& sig, const Limbs& s_inv) noexcept;
+    Limbs (*inv_n)(const Limbs& a) noexcept;
+    const char* name;
+};
+
+SILKPRE_FLATTEN bool verify_generic(const Signature& sig, const Limbs& s_inv) noexcept { return verify(sig, s_inv); }
+
+SILKPRE_FLATTEN Limbs inv_n_generic(const Limbs& a) noexcept { return mont_inv(a, kN); }
+
+#if defined(SILKPRE_P256_X86)
+
+// MULX leaves the flags alone, which helps the carry chains of the Montgomery multiplication
+__attribute__((target("bmi2,adx"))) SILKPRE_FLATTEN bool verify_bmi2(const Signature& sig,
+                                                                     const Limbs& s_inv) noexcept {
+    return verify(sig, s_inv);
+}
+
+__attribute__((target("bmi2,adx"))) SILKPRE_FLATTEN Limbs inv_n_bmi2(const Limbs& a) noexcept {
+    return mont_inv(a, kN);
+}
+
+#endif
+
+Kernel select_kernel(uint32_t features) noexcept {
+#if defined(SILKPRE_P256_X86)
+    if ((features & SILKPRE_CPU_BMI2) && (features & SILKPRE_CPU_ADX)) {
+        return {verify_bmi2, inv_n_bmi2, "x86_bmi2_adx"};
+    }
+#endif
+    (void)features;
+    return {verify_generic, inv_n_generic, "generic"};
+}
+
+}  // namespace
+
+const char* silkpre_p256_kernel(uint32_t features) { return select_kernel(features).name; }
+
+void silkpre_p256_init(void) { context(); }
+
+bool silkpre_p256_verify(const uint8_t hash[32], const uint8_t r[32], const uint8_t s[32], const uint8_t qx[32],
+                         const uint8_t qy[32]) {
+    uint8_t input[SILKPRE_P256_VERIFY_INPUT_SIZE];
+    std::copy_n(hash, 32, input);
+    std::copy_n(r, 32, input + 32);
+    std::copy_n(s, 32, input + 64);
+    std::copy_n(qx, 32, input + 96);
+    std::copy_n(qy, 32, input + 128);
+
+    Signature sig;
+    if (!parse(sig, input)) {
+        return false;
+    }
+    const Kernel kernel{select_kernel(silkpre_cpu_features())};
+    return kernel.verify(sig, kernel.inv_n(to_mont(sig.s, kN)));
+}
+
+void silkpre_p256_verify_batch(bool* results, const uint8_t* input, size_t n) {
+    const Kernel kernel{select_kernel(silkpre_cpu_features())};
+    std::vector<Signature> sigs(n);
+    std::vector<Limbs> prefix(n);
+
+    // Montgomery's trick: a single inversion of the product of all s values
+    Limbs acc{to_mont({1, 0, 0, 0}, kN)};
+    for (size_t i{0}; i < n; ++i) {
+        results[i] = parse(sigs[i], input + i * SILKPRE_P256_VERIFY_INPUT_SIZE);
+        if (results[i]) {
+            sigs[i].s = to_mont(sigs[i].s, kN);
+            prefix[i] = acc;
+            acc = mont_mul(acc, sigs[i].s, kN);
+        }
+    }
+
+    Limbs inv{kernel.inv_n(acc)};
+    for (size_t i{n}; i-- > 0;) {
+        if (results[i]) {
+            const Limbs s_inv{mont_mul(inv, prefix[i], kN)};
+            inv = mont_mul(inv, sigs[i].s, kN);
+            results[i] = kernel.verify(sigs[i], s_inv);
+        }
+    }
+}
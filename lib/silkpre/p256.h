@@ -0,0 +1,57 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_P256_H_
+#define SILKPRE_P256_H_
+
+// ECDSA verification over NIST P-256 (secp256r1), see
+// https://github.com/ethereum/RIPs/blob/master/RIPS/rip-7212.md
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Layout of a single verification record: hash | r | s | qx | qy, all 32-byte big-endian.
+enum { SILKPRE_P256_VERIFY_INPUT_SIZE = 160 };
+
+//! \brief Precomputes the multiples of the generator, otherwise done on the first verification
+void silkpre_p256_init(void);
+
+//! \brief Verifies an ECDSA signature over the secp256r1 curve
+//! \param [in] hash : the signed message hash
+//! \param [in] r : signature's r
+//! \param [in] s : signature's s
+//! \param [in] qx : x coordinate of the public key
+//! \param [in] qy : y coordinate of the public key
+//! \return Whether the signature is valid
+bool silkpre_p256_verify(const uint8_t hash[32], const uint8_t r[32], const uint8_t s[32], const uint8_t qx[32],
+                         const uint8_t qy[32]);
+
+//! \brief Verifies n signatures at once, sharing a single modular inversion between them
+//! \param [out] results : n verification results
+//! \param [in] input : n records of SILKPRE_P256_VERIFY_INPUT_SIZE bytes each
+//! \param [in] n : number of records
+void silkpre_p256_verify_batch(bool* results, const uint8_t* input, size_t n);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_P256_H_
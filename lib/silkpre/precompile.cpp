@@ -19,39 +19,47 @@
 #include <gmp.h>
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cstring>
 #include <limits>
+#include <vector>
 
 #include <intx/intx.hpp>
 #include <libff/algebra/curves/alt_bn128/alt_bn128_pairing.hpp>
 #include <libff/algebra/curves/alt_bn128/alt_bn128_pp.hpp>
 #include <libff/common/profiling.hpp>
 
+#include <silkpre/arena.hpp>
 #include <silkpre/blake2b.h>
+#include <silkpre/budget.hpp>
+#include <silkpre/copy.h>
+#include <silkpre/cpu.h>
 #include <silkpre/ecdsa.h>
+#include <silkpre/montgomery.hpp>
+#include <silkpre/p256.h>
+#include <silkpre/prefetch.hpp>
 #include <silkpre/rmd160.h>
+#include <silkpre/secp256k1_context.h>
 #include <silkpre/secp256k1n.hpp>
 #include <silkpre/sha256.h>
-
-enum {
-    EVMC_ISTANBUL = 7,
-    EVMC_BERLIN = 8,
-};
-
-static void right_pad(std::basic_string<uint8_t>& str, const size_t min_size) noexcept {
-    if (str.length() < min_size) {
-        str.resize(min_size, '\0');
-    }
+#include <silkpre/stats.hpp>
+
+// Copies the input into a fixed-size buffer, zero-padded on the right
+template <size_t N>
+static void right_pad(uint8_t (&out)[N], const uint8_t* input, size_t len) noexcept {
+    const size_t n{std::min(len, N)};
+    std::memcpy(out, input, n);
+    std::memset(out + n, 0, N - n);
 }
 
 uint64_t silkpre_ecrec_gas(const uint8_t*, size_t, int) { return 3'000; }
 
 SilkpreOutput silkpre_ecrec_run(const uint8_t* input, size_t len) {
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(32))};
+    uint8_t* out{silkpre::alloc_output(32)};
 
-    std::basic_string<uint8_t> d(input, len);
-    right_pad(d, 128);
+    uint8_t d[128];
+    right_pad(d, input, len);
 
     const auto v{intx::be::unsafe::load<intx::uint256>(&d[32])};
     const auto r{intx::be::unsafe::load<intx::uint256>(&d[64])};
@@ -67,8 +75,7 @@ SilkpreOutput silkpre_ecrec_run(const uint8_t* input, size_t len) {
     }
 
     std::memset(out, 0, 12);
-    static secp256k1_context* context{secp256k1_context_create(SILKPRE_SECP256K1_CONTEXT_FLAGS)};
-    if (!silkpre_recover_address(out + 12, &d[0], &d[64], v != 27, context)) {
+    if (!silkpre_recover_address(out + 12, &d[0], &d[64], v != 27, silkpre_secp256k1_context())) {
         return {out, 0};
     }
     return {out, 32};
@@ -77,7 +84,7 @@ SilkpreOutput silkpre_ecrec_run(const uint8_t* input, size_t len) {
 uint64_t silkpre_sha256_gas(const uint8_t*, size_t len, int) { return 60 + 12 * ((len + 31) / 32); }
 
 SilkpreOutput silkpre_sha256_run(const uint8_t* input, size_t len) {
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(32))};
+    uint8_t* out{silkpre::alloc_output(32)};
     silkpre_sha256(out, input, len, /*use_cpu_extensions=*/true);
     return {out, 32};
 }
@@ -85,7 +92,7 @@ SilkpreOutput silkpre_sha256_run(const uint8_t* input, size_t len) {
 uint64_t silkpre_rip160_gas(const uint8_t*, size_t len, int) { return 600 + 120 * ((len + 31) / 32); }
 
 SilkpreOutput silkpre_rip160_run(const uint8_t* input, size_t len) {
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(32))};
+    uint8_t* out{silkpre::alloc_output(32)};
     std::memset(out, 0, 12);
     silkpre_rmd160(&out[12], input, len);
     return {out, 32};
@@ -94,11 +101,16 @@ SilkpreOutput silkpre_rip160_run(const uint8_t* input, size_t len) {
 uint64_t silkpre_id_gas(const uint8_t*, size_t len, int) { return 15 + 3 * ((len + 31) / 32); }
 
 SilkpreOutput silkpre_id_run(const uint8_t* input, size_t len) {
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(len))};
-    std::memcpy(out, input, len);
+    uint8_t* out{silkpre::alloc_output(len)};
+    silkpre_copy(out, input, len);
     return {out, len};
 }
 
+bool silkpre_id_view(const uint8_t* input, size_t len, SilkpreView* view) {
+    *view = {input, len};
+    return true;
+}
+
 static intx::uint256 mult_complexity_eip198(const intx::uint256& x) noexcept {
     const intx::uint256 x_squared{x * x};
     if (x <= 64) {
@@ -115,45 +127,58 @@ static intx::uint256 mult_complexity_eip2565(const intx::uint256& max_length) no
     return words * words;
 }
 
-uint64_t silkpre_expmod_gas(const uint8_t* ptr, size_t len, int rev) {
-    const uint64_t min_gas{rev < EVMC_BERLIN ? 0 : 200u};
+// Copies n bytes of the input starting at offset; the input is implicitly right-padded with zeros.
+static void read_padded(uint8_t* out, const uint8_t* input, size_t len, uint64_t offset, size_t n) noexcept {
+    const size_t available{offset < len ? std::min<size_t>(n, len - offset) : 0};
+    if (available) {
+        std::memcpy(out, input + offset, available);
+    }
+    std::memset(out + available, 0, n - available);
+}
+
+static uint64_t saturating_add(uint64_t a, uint64_t b) noexcept { return a + b < a ? UINT64_MAX : a + b; }
+
+// Header of the EIP-198 input; the input itself is referenced, never copied.
+struct ExpmodInput {
+    const uint8_t* data;
+    size_t len;
+    intx::uint256 base_len;
+    intx::uint256 exp_len;
+    intx::uint256 mod_len;
+};
 
-    std::basic_string<uint8_t> input(ptr, len);
-    right_pad(input, 3 * 32);
+static ExpmodInput parse_expmod_input(const uint8_t* ptr, size_t len) noexcept {
+    uint8_t header[3 * 32];
+    read_padded(header, ptr, len, 0, sizeof(header));
+    return {ptr, len, intx::be::unsafe::load<intx::uint256>(&header[0]),
+            intx::be::unsafe::load<intx::uint256>(&header[32]), intx::be::unsafe::load<intx::uint256>(&header[64])};
+}
 
-    intx::uint256 base_len256{intx::be::unsafe::load<intx::uint256>(&input[0])};
-    intx::uint256 exp_len256{intx::be::unsafe::load<intx::uint256>(&input[32])};
-    intx::uint256 mod_len256{intx::be::unsafe::load<intx::uint256>(&input[64])};
+static uint64_t expmod_gas(const ExpmodInput& in, int rev) noexcept {
+    const uint64_t min_gas{rev < SILKPRE_EVMC_BERLIN ? 0 : 200u};
 
-    if (base_len256 == 0 && mod_len256 == 0) {
+    if (in.base_len == 0 && in.mod_len == 0) {
         return min_gas;
     }
 
-    if (intx::count_significant_words(base_len256) > 1 || intx::count_significant_words(exp_len256) > 1 ||
-        intx::count_significant_words(mod_len256) > 1) {
+    if (intx::count_significant_words(in.base_len) > 1 || intx::count_significant_words(in.exp_len) > 1 ||
+        intx::count_significant_words(in.mod_len) > 1) {
         return UINT64_MAX;
     }
 
-    uint64_t base_len64{static_cast<uint64_t>(base_len256)};
-    uint64_t exp_len64{static_cast<uint64_t>(exp_len256)};
-
-    input.erase(0, 3 * 32);
+    const uint64_t base_len64{static_cast<uint64_t>(in.base_len)};
+    const uint64_t exp_len64{static_cast<uint64_t>(in.exp_len)};
 
-    intx::uint256 exp_head{0};  // first 32 bytes of the exponent
-    if (input.length() > base_len64) {
-        input.erase(0, base_len64);
-        right_pad(input, 3 * 32);
-        if (exp_len64 < 32) {
-            input.erase(exp_len64);
-            input.insert(0, 32 - exp_len64, '\0');
-        }
-        exp_head = intx::be::unsafe::load<intx::uint256>(input.data());
-    }
+    // first 32 bytes of the exponent
+    uint8_t exp_bytes[32]{};
+    const size_t exp_head_len{static_cast<size_t>(std::min<uint64_t>(exp_len64, 32))};
+    read_padded(&exp_bytes[32 - exp_head_len], in.data, in.len, saturating_add(3 * 32, base_len64), exp_head_len);
+    const intx::uint256 exp_head{intx::be::unsafe::load<intx::uint256>(exp_bytes)};
     unsigned bit_len{256 - clz(exp_head)};
 
     intx::uint256 adjusted_exponent_len{0};
-    if (exp_len256 > 32) {
-        adjusted_exponent_len = 8 * (exp_len256 - 32);
+    if (in.exp_len > 32) {
+        adjusted_exponent_len = 8 * (in.exp_len - 32);
     }
     if (bit_len > 1) {
         adjusted_exponent_len += bit_len - 1;
@@ -163,10 +188,10 @@ uint64_t silkpre_expmod_gas(const uint8_t* ptr, size_t len, int rev) {
         adjusted_exponent_len = 1;
     }
 
-    const intx::uint256 max_length{std::max(mod_len256, base_len256)};
+    const intx::uint256 max_length{std::max(in.mod_len, in.base_len)};
 
     intx::uint256 gas;
-    if (rev < EVMC_BERLIN) {
+    if (rev < SILKPRE_EVMC_BERLIN) {
         gas = mult_complexity_eip198(max_length) * adjusted_exponent_len / 20;
     } else {
         gas = mult_complexity_eip2565(max_length) * adjusted_exponent_len / 3;
@@ -179,73 +204,162 @@ uint64_t silkpre_expmod_gas(const uint8_t* ptr, size_t len, int rev) {
     }
 }
 
-SilkpreOutput silkpre_expmod_run(const uint8_t* ptr, size_t len) {
-    std::basic_string<uint8_t> input(ptr, len);
-    right_pad(input, 3 * 32);
+uint64_t silkpre_expmod_gas(const uint8_t* ptr, size_t len, int rev) {
+    return expmod_gas(parse_expmod_input(ptr, len), rev);
+}
 
-    const uint64_t base_len{intx::be::unsafe::load<uint64_t>(&input[24])};
-    input.erase(0, 32);
+// Imports n bytes of the input starting at offset as a big-endian number.
+// Missing trailing bytes are zeros, i.e. they scale the number by a power of 256.
+static void import_padded(mpz_t x, const uint8_t* input, size_t len, uint64_t offset, uint64_t n) noexcept {
+    const uint64_t available{offset < len ? std::min<uint64_t>(n, len - offset) : 0};
+    if (available) {
+        mpz_import(x, available, 1, 1, 0, 0, input + offset);
+        if (available < n) {
+            mpz_mul_2exp(x, x, 8 * (n - available));
+        }
+    }
+}
 
-    const uint64_t exponent_len{intx::be::unsafe::load<uint64_t>(&input[24])};
-    input.erase(0, 32);
+static bool budget_expired() noexcept { return silkpre::budget::expired(); }
+
+// Same as mpz_powm, but checks the budget after each window of the exponent. Left-to-right 4-bit windows
+// with plain division for the reduction, which works for all moduli but is slower than GMP's.
+static bool powm_polled(mpz_t result, const mpz_t base, const mpz_t exponent, const mpz_t modulus) noexcept {
+    constexpr unsigned kWindowBits{4};
+    mpz_t table[1 << kWindowBits];
+    mpz_init_set_ui(table[0], 1);
+    mpz_init(table[1]);
+    mpz_tdiv_r(table[1], base, modulus);
+    for (size_t i{2}; i < std::size(table); ++i) {
+        mpz_init(table[i]);
+        mpz_mul(table[i], table[i - 1], table[1]);
+        mpz_tdiv_r(table[i], table[i], modulus);
+    }
+
+    mpz_tdiv_r(result, table[0], modulus);
+    bool ok{true};
+    const size_t bits{mpz_sgn(exponent) ? mpz_sizeinbase(exponent, 2) : 0};
+    for (size_t pos{(bits + kWindowBits - 1) / kWindowBits * kWindowBits}; pos > 0; pos -= kWindowBits) {
+        if (budget_expired()) {
+            ok = false;
+            break;
+        }
+        unsigned digit{0};
+        for (unsigned j{1}; j <= kWindowBits; ++j) {
+            digit = (digit << 1) | static_cast<unsigned>(mpz_tstbit(exponent, pos - j));
+            mpz_mul(result, result, result);
+            mpz_tdiv_r(result, result, modulus);
+        }
+        if (digit) {
+            mpz_mul(result, result, table[digit]);
+            mpz_tdiv_r(result, result, modulus);
+        }
+    }
 
-    const uint64_t modulus_len{intx::be::unsafe::load<uint64_t>(&input[24])};
-    input.erase(0, 32);
+    for (mpz_t& x : table) {
+        mpz_clear(x);
+    }
+    return ok;
+}
+
+// mpz_powm can't be interrupted, which doesn't matter for short calls. Up to this much work, in limbs of
+// the modulus squared times bits of the exponent (a 1024-bit exponentiation), it runs in about a millisecond.
+static constexpr uint64_t kUnpolledMaxWork{1 << 18};
+
+// mpz_powm under a budget: unpolled when short, otherwise polled after each window of the exponent.
+// Odd moduli keep Montgomery reduction, close to mpz_powm; splitting the exponent into chunks of
+// mpz_powm calls instead would compute each chunk's power of the base separately, doubling the squarings.
+static bool powm_budget(mpz_t result, mpz_t base, const mpz_t exponent, const mpz_t modulus) noexcept {
+    const uint64_t limbs{mpz_size(modulus)};
+    if (mpz_sizeinbase(exponent, 2) <= kUnpolledMaxWork / (limbs * limbs)) {
+        if (budget_expired()) {
+            return false;
+        }
+        mpz_powm(result, base, exponent, modulus);
+        return true;
+    }
+    if (!mpz_odd_p(modulus)) {
+        return powm_polled(result, base, exponent, modulus);
+    }
+    if (mpz_cmp(base, modulus) >= 0) {
+        mpz_tdiv_r(base, base, modulus);
+    }
+    // Not from the context cache: untrusted calls with large moduli would only churn it
+    const silkpre::MontgomeryContext context{mpz_limbs_read(modulus), limbs};
+    return context.powm(result, base, exponent, budget_expired);
+}
+
+// mpz_powm redoes the setup of the modulus on every call. It's worth skipping with a cached
+// context only when the exponentiation itself is short, as with the RSA public exponents 3 and 65537;
+// longer ones are faster with GMP's assembly reduction.
+static constexpr size_t kMontgomeryMinModulusBits{1024};
+static constexpr size_t kMontgomeryMaxExponentBits{17};
+
+static SilkpreOutput expmod_run(const ExpmodInput& in) noexcept {
+    // Lengths are assumed to have been vetted by the gas function
+    const uint64_t base_len{static_cast<uint64_t>(in.base_len)};
+    const uint64_t exponent_len{static_cast<uint64_t>(in.exp_len)};
+    const uint64_t modulus_len{static_cast<uint64_t>(in.mod_len)};
 
     if (modulus_len == 0) {
-        uint8_t* out{static_cast<uint8_t*>(std::malloc(1))};
+        uint8_t* out{silkpre::alloc_output(1)};
         return {out, 0};
     }
 
-    right_pad(input, base_len + exponent_len + modulus_len);
+    const uint64_t base_offset{3 * 32};
+    const uint64_t exponent_offset{saturating_add(base_offset, base_len)};
+    const uint64_t modulus_offset{saturating_add(exponent_offset, exponent_len)};
 
     mpz_t base;
     mpz_init(base);
-    if (base_len) {
-        mpz_import(base, base_len, 1, 1, 0, 0, input.data());
-        input.erase(0, base_len);
-    }
+    import_padded(base, in.data, in.len, base_offset, base_len);
 
     mpz_t exponent;
     mpz_init(exponent);
-    if (exponent_len) {
-        mpz_import(exponent, exponent_len, 1, 1, 0, 0, input.data());
-        input.erase(0, exponent_len);
-    }
+    import_padded(exponent, in.data, in.len, exponent_offset, exponent_len);
 
     mpz_t modulus;
     mpz_init(modulus);
-    mpz_import(modulus, modulus_len, 1, 1, 0, 0, input.data());
-
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(modulus_len))};
-    std::memset(out, 0, modulus_len);
-
-    if (mpz_sgn(modulus) == 0) {
-        mpz_clear(modulus);
-        mpz_clear(exponent);
-        mpz_clear(base);
-
-        return {out, static_cast<size_t>(modulus_len)};
-    }
+    import_padded(modulus, in.data, in.len, modulus_offset, modulus_len);
 
     mpz_t result;
     mpz_init(result);
 
-    mpz_powm(result, base, exponent, modulus);
+    bool ok{true};
+    if (mpz_sgn(modulus) == 0) {
+        // the output is all zeros
+    } else if (mpz_odd_p(modulus) && mpz_sizeinbase(modulus, 2) >= kMontgomeryMinModulusBits &&
+               mpz_sizeinbase(exponent, 2) <= kMontgomeryMaxExponentBits) {
+        if (mpz_cmp(base, modulus) >= 0) {
+            mpz_tdiv_r(base, base, modulus);
+        }
+        silkpre::montgomery_context(modulus)->powm(result, base, exponent);
+    } else if (silkpre::budget::active()) {
+        ok = powm_budget(result, base, exponent, modulus);
+    } else {
+        mpz_powm(result, base, exponent, modulus);
+    }
 
-    // export as little-endian
-    mpz_export(out, nullptr, -1, 1, 0, 0, result);
-    // and convert to big-endian
-    std::reverse(out, out + modulus_len);
+    uint8_t* out{nullptr};
+    if (ok) {
+        out = silkpre::alloc_output(modulus_len);
+        std::memset(out, 0, modulus_len);
+        // export as little-endian
+        mpz_export(out, nullptr, -1, 1, 0, 0, result);
+        // and convert to big-endian
+        std::reverse(out, out + modulus_len);
+    }
 
     mpz_clear(result);
     mpz_clear(modulus);
     mpz_clear(exponent);
     mpz_clear(base);
 
-    return {out, static_cast<size_t>(modulus_len)};
+    return {out, ok ? static_cast<size_t>(modulus_len) : 0};
 }
 
+SilkpreOutput silkpre_expmod_run(const uint8_t* ptr, size_t len) { return expmod_run(parse_expmod_input(ptr, len)); }
+
 // Utility functions for zkSNARK related precompiled contracts.
 // See Yellow Paper, Appendix E "Precompiled Contracts", as well as
 // https://eips.ethereum.org/EIPS/eip-196
@@ -341,10 +455,10 @@ static std::optional<libff::alt_bn128_G2> decode_g2_element(const uint8_t bytes_
     return point;
 }
 
-static std::basic_string<uint8_t> encode_g1_element(libff::alt_bn128_G1 p) noexcept {
-    std::basic_string<uint8_t> out(64, '\0');
+static void encode_g1_element(uint8_t out[64], libff::alt_bn128_G1 p) noexcept {
     if (p.is_zero()) {
-        return out;
+        std::memset(out, 0, 64);
+        return;
     }
 
     p.to_affine_coordinates();
@@ -358,19 +472,18 @@ static std::basic_string<uint8_t> encode_g1_element(libff::alt_bn128_G1 p) noexc
     std::memcpy(&out[0], y.data, 32);
     std::memcpy(&out[32], x.data, 32);
 
-    std::reverse(out.begin(), out.end());
-    return out;
+    std::reverse(out, out + 64);
 }
 
-uint64_t silkpre_bn_add_gas(const uint8_t*, size_t, int rev) { return rev >= EVMC_ISTANBUL ? 150 : 500; }
+uint64_t silkpre_bn_add_gas(const uint8_t*, size_t, int rev) { return rev >= SILKPRE_EVMC_ISTANBUL ? 150 : 500; }
 
 SilkpreOutput silkpre_bn_add_run(const uint8_t* ptr, size_t len) {
-    std::basic_string<uint8_t> input(ptr, len);
-    right_pad(input, 128);
+    uint8_t input[128];
+    right_pad(input, ptr, len);
 
     init_libff();
 
-    std::optional<libff::alt_bn128_G1> x{decode_g1_element(input.data())};
+    std::optional<libff::alt_bn128_G1> x{decode_g1_element(input)};
     if (!x) {
         return {nullptr, 0};
     }
@@ -381,41 +494,94 @@ SilkpreOutput silkpre_bn_add_run(const uint8_t* ptr, size_t len) {
     }
 
     libff::alt_bn128_G1 sum{*x + *y};
-    const std::basic_string<uint8_t> res{encode_g1_element(sum)};
+    uint8_t* out{silkpre::alloc_output(64)};
+    encode_g1_element(out, sum);
+    return {out, 64};
+}
+
+uint64_t silkpre_bn_mul_gas(const uint8_t*, size_t, int rev) { return rev >= SILKPRE_EVMC_ISTANBUL ? 6'000 : 40'000; }
+
+// Multiples of the generator (1, 2), e.g. public-input commitments of verifiers, go through a comb table:
+// entry j - 1 is the sum of 2^(32t) * G over the bits t of j, so that a 256-bit scalar takes 31 doublings
+// and at most 32 mixed additions instead of about 255 doublings and 128 additions.
+static constexpr size_t kCombTeeth{8};
+static constexpr size_t kCombSpacing{256 / kCombTeeth};
 
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(res.length()))};
-    std::memcpy(out, res.data(), res.length());
-    return {out, res.length()};
+static const std::vector<libff::alt_bn128_G1>& generator_comb() noexcept {
+    // magic static
+    static const auto* table{[]() noexcept {
+        init_libff();
+
+        std::array<libff::alt_bn128_G1, kCombTeeth> teeth;  // 2^(32t) * G
+        teeth[0] = libff::alt_bn128_G1::one();
+        for (size_t t{1}; t < kCombTeeth; ++t) {
+            teeth[t] = teeth[t - 1];
+            for (size_t i{0}; i < kCombSpacing; ++i) {
+                teeth[t] = teeth[t].dbl();
+            }
+        }
+
+        auto* entries{new std::vector<libff::alt_bn128_G1>((size_t{1} << kCombTeeth) - 1)};
+        for (size_t t{0}; t < kCombTeeth; ++t) {
+            const size_t top{size_t{1} << t};
+            (*entries)[top - 1] = teeth[t];
+            for (size_t j{top + 1}; j < 2 * top; ++j) {
+                (*entries)[j - 1] = (*entries)[j - top - 1] + teeth[t];
+            }
+        }
+        // Affine, for mixed additions; none is zero since all the multiples are below the group order
+        libff::alt_bn128_G1::batch_to_special_all_non_zeros(*entries);
+        return entries;
+    }()};
+    return *table;
 }
 
-uint64_t silkpre_bn_mul_gas(const uint8_t*, size_t, int rev) { return rev >= EVMC_ISTANBUL ? 6'000 : 40'000; }
+static bool is_g1_generator(const uint8_t bytes_be[64]) noexcept {
+    static constexpr uint8_t kZeroes[31]{};
+    return bytes_be[31] == 1 && bytes_be[63] == 2 && std::memcmp(bytes_be, kZeroes, 31) == 0 &&
+           std::memcmp(bytes_be + 32, kZeroes, 31) == 0;
+}
+
+static libff::alt_bn128_G1 generator_mul(const Scalar& n) noexcept {
+    const std::vector<libff::alt_bn128_G1>& comb{generator_comb()};
+    libff::alt_bn128_G1 product{libff::alt_bn128_G1::zero()};
+    for (size_t i{kCombSpacing}; i-- > 0;) {
+        product = product.dbl();
+        size_t j{0};
+        for (size_t t{0}; t < kCombTeeth; ++t) {
+            j |= static_cast<size_t>(n.test_bit(t * kCombSpacing + i)) << t;
+        }
+        if (j) {
+            product = product.mixed_add(comb[j - 1]);
+        }
+    }
+    return product;
+}
 
 SilkpreOutput silkpre_bn_mul_run(const uint8_t* ptr, size_t len) {
-    std::basic_string<uint8_t> input(ptr, len);
-    right_pad(input, 96);
+    uint8_t input[96];
+    right_pad(input, ptr, len);
 
     init_libff();
 
-    std::optional<libff::alt_bn128_G1> x{decode_g1_element(input.data())};
+    std::optional<libff::alt_bn128_G1> x{decode_g1_element(input)};
     if (!x) {
         return {nullptr, 0};
     }
 
     Scalar n{to_scalar(&input[64])};
 
-    libff::alt_bn128_G1 product{n * *x};
-    const std::basic_string<uint8_t> res{encode_g1_element(product)};
-
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(res.length()))};
-    std::memcpy(out, res.data(), res.length());
-    return {out, res.length()};
+    libff::alt_bn128_G1 product{is_g1_generator(input) ? generator_mul(n) : n * *x};
+    uint8_t* out{silkpre::alloc_output(64)};
+    encode_g1_element(out, product);
+    return {out, 64};
 }
 
 static constexpr size_t kSnarkvStride{192};
 
 uint64_t silkpre_snarkv_gas(const uint8_t*, size_t len, int rev) {
     uint64_t k{len / kSnarkvStride};
-    return rev >= EVMC_ISTANBUL ? 34'000 * k + 45'000 : 80'000 * k + 100'000;
+    return rev >= SILKPRE_EVMC_ISTANBUL ? 34'000 * k + 45'000 : 80'000 * k + 100'000;
 }
 
 SilkpreOutput silkpre_snarkv_run(const uint8_t* input, size_t len) {
@@ -447,7 +613,7 @@ SilkpreOutput silkpre_snarkv_run(const uint8_t* input, size_t len) {
         accumulator = accumulator * alt_bn128_miller_loop(alt_bn128_precompute_G1(*a), alt_bn128_precompute_G2(*b));
     }
 
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(32))};
+    uint8_t* out{silkpre::alloc_output(32)};
     std::memset(out, 0, 32);
     if (alt_bn128_final_exponentiation(accumulator) == one) {
         out[31] = 1;
@@ -487,17 +653,201 @@ SilkpreOutput silkpre_blake2_f_run(const uint8_t* input, size_t len) {
     std::memcpy(&state.t, input + 196, 8 * 2);
 
     uint32_t r{intx::be::unsafe::load<uint32_t>(input)};
-    silkpre_blake2b_compress(&state, block, r);
+    if (!silkpre::budget::active()) {
+        silkpre_blake2b_compress(&state, block, r);
+    } else if (!silkpre_blake2b_compress_polled(&state, block, r, budget_expired)) {
+        return {nullptr, 0};
+    }
 
-    uint8_t* out{static_cast<uint8_t*>(std::malloc(64))};
+    uint8_t* out{silkpre::alloc_output(64)};
     std::memcpy(&out[0], &state.h[0], 8 * 8);
     return {out, 64};
 }
 
+uint64_t silkpre_p256verify_gas(const uint8_t*, size_t, int) { return 3'450; }
+
+SilkpreOutput silkpre_p256verify_run(const uint8_t* input, size_t len) {
+    uint8_t* out{silkpre::alloc_output(32)};
+    if (len != SILKPRE_P256_VERIFY_INPUT_SIZE) {
+        return {out, 0};
+    }
+    if (!silkpre_p256_verify(input, &input[32], &input[64], &input[96], &input[128])) {
+        return {out, 0};
+    }
+    std::memset(out, 0, 32);
+    out[31] = 1;
+    return {out, 32};
+}
+
+#if defined(SILKPRE_STATS)
+
+// Instrumented entries: the gas charged by gas() is attributed to the run() that follows on the same thread
+
+template <SilkpreGasFunction Gas, size_t Index>
+static uint64_t counted_gas(const uint8_t* input, size_t len, int evmc_revision) {
+    const uint64_t gas{Gas(input, len, evmc_revision)};
+    silkpre::stats::charged(Index, gas);
+    return gas;
+}
+
+template <SilkpreRunFunction Run, size_t Index>
+static SilkpreOutput timed_run(const uint8_t* input, size_t len) {
+    const uint64_t gas{silkpre::stats::take_charged(Index)};
+    silkpre::stats::Timer timer{Index, len};
+    const SilkpreOutput out{Run(input, len)};
+    timer.stop(gas);
+    return out;
+}
+
+#define SILKPRE_CONTRACT(gas, run, index) {counted_gas<gas, index>, timed_run<run, index>}
+
+#else
+
+#define SILKPRE_CONTRACT(gas, run, index) {gas, run}
+
+#endif  // SILKPRE_STATS
+
 const SilkpreContract kSilkpreContracts[SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS] = {
-    {silkpre_ecrec_gas, silkpre_ecrec_run},       {silkpre_sha256_gas, silkpre_sha256_run},
-    {silkpre_rip160_gas, silkpre_rip160_run},     {silkpre_id_gas, silkpre_id_run},
-    {silkpre_expmod_gas, silkpre_expmod_run},     {silkpre_bn_add_gas, silkpre_bn_add_run},
-    {silkpre_bn_mul_gas, silkpre_bn_mul_run},     {silkpre_snarkv_gas, silkpre_snarkv_run},
-    {silkpre_blake2_f_gas, silkpre_blake2_f_run},
+    SILKPRE_CONTRACT(silkpre_ecrec_gas, silkpre_ecrec_run, 0),
+    SILKPRE_CONTRACT(silkpre_sha256_gas, silkpre_sha256_run, 1),
+    SILKPRE_CONTRACT(silkpre_rip160_gas, silkpre_rip160_run, 2),
+    SILKPRE_CONTRACT(silkpre_id_gas, silkpre_id_run, 3),
+    SILKPRE_CONTRACT(silkpre_expmod_gas, silkpre_expmod_run, 4),
+    SILKPRE_CONTRACT(silkpre_bn_add_gas, silkpre_bn_add_run, 5),
+    SILKPRE_CONTRACT(silkpre_bn_mul_gas, silkpre_bn_mul_run, 6),
+    SILKPRE_CONTRACT(silkpre_snarkv_gas, silkpre_snarkv_run, 7),
+    SILKPRE_CONTRACT(silkpre_blake2_f_gas, silkpre_blake2_f_run, 8),
 };
+
+const SilkpreContract kSilkpreP256VerifyContract = SILKPRE_CONTRACT(silkpre_p256verify_gas, silkpre_p256verify_run, 9);
+
+#undef SILKPRE_CONTRACT
+
+static const SilkpreContractDescriptor kDescriptors[SILKPRE_NUMBER_OF_CONTRACTS] = {
+    {silkpre_ecrec_gas, silkpre_ecrec_run, "ecrecover", 0x01, 0, 32, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_sha256_gas, silkpre_sha256_run, "sha256", 0x02, 1, 32, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_rip160_gas, silkpre_rip160_run, "ripemd160", 0x03, 2, 32, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_id_gas, silkpre_id_run, "identity", 0x04, 3, 0, SILKPRE_CONTRACT_PURE, silkpre_id_view},
+    {silkpre_expmod_gas, silkpre_expmod_run, "modexp", 0x05, 4, 0, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_bn_add_gas, silkpre_bn_add_run, "bn256_add", 0x06, 5, 64, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_bn_mul_gas, silkpre_bn_mul_run, "bn256_mul", 0x07, 6, 64, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_snarkv_gas, silkpre_snarkv_run, "bn256_pairing", 0x08, 7, 32, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_blake2_f_gas, silkpre_blake2_f_run, "blake2f", 0x09, 8, 64, SILKPRE_CONTRACT_PURE, nullptr},
+    {silkpre_p256verify_gas, silkpre_p256verify_run, "p256verify", SILKPRE_P256VERIFY_ADDRESS, 9, 32,
+     SILKPRE_CONTRACT_PURE, nullptr},
+};
+
+// Dense dispatch table: kDispatch[revision][address] is 1 + index of the descriptor or 0 if there is none.
+static constexpr size_t kDispatchAddresses{16};
+using DispatchTable = std::array<std::array<uint8_t, kDispatchAddresses>, SILKPRE_EVMC_BERLIN + 1>;
+
+static constexpr DispatchTable make_dispatch_table() noexcept {
+    DispatchTable table{};
+    for (int rev{0}; rev <= SILKPRE_EVMC_BERLIN; ++rev) {
+        size_t n{SILKPRE_NUMBER_OF_FRONTIER_CONTRACTS};
+        if (rev >= SILKPRE_EVMC_ISTANBUL) {
+            n = SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS;
+        } else if (rev >= SILKPRE_EVMC_BYZANTIUM) {
+            n = SILKPRE_NUMBER_OF_BYZANTIUM_CONTRACTS;
+        }
+        for (size_t i{0}; i < n; ++i) {
+            table[static_cast<size_t>(rev)][i + 1] = static_cast<uint8_t>(i + 1);
+        }
+    }
+    return table;
+}
+
+static constexpr DispatchTable kDispatch{make_dispatch_table()};
+
+void silkpre_init(uint32_t flags) {
+    if (flags & SILKPRE_INIT_CPU) {
+        silkpre_cpu_features();
+    }
+    if (flags & SILKPRE_INIT_SECP256K1) {
+        silkpre_secp256k1_context();
+    }
+    if (flags & SILKPRE_INIT_BN254) {
+        init_libff();
+        generator_comb();
+    }
+    if (flags & SILKPRE_INIT_P256) {
+        silkpre_p256_init();
+    }
+}
+
+const SilkpreContractDescriptor* silkpre_lookup(const uint8_t address[20], int evmc_revision) {
+    uint64_t head[2];
+    std::memcpy(head, address, sizeof(head));
+    if ((head[0] | head[1] | address[16] | address[17] | address[18]) != 0 || address[19] >= kDispatchAddresses ||
+        evmc_revision < 0) {
+        return nullptr;
+    }
+    const size_t rev{std::min(static_cast<size_t>(evmc_revision), size_t{SILKPRE_EVMC_BERLIN})};
+    const uint8_t id{kDispatch[rev][address[19]]};
+    return id ? &kDescriptors[id - 1] : nullptr;
+}
+
+const SilkpreContractDescriptor* silkpre_contract_descriptor(size_t index) {
+    return index < SILKPRE_NUMBER_OF_CONTRACTS ? &kDescriptors[index] : nullptr;
+}
+
+static SilkpreStatus finish(const SilkpreOutput& res, uint64_t gas, uint64_t gas_limit, uint64_t* gas_used,
+                            SilkpreOutput* output) noexcept {
+    if (!res.data) {
+        *gas_used = gas_limit;
+        return SILKPRE_INVALID_INPUT;
+    }
+    *gas_used = gas;
+    *output = res;
+    return SILKPRE_SUCCESS;
+}
+
+SilkpreStatus silkpre_execute(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                              int evmc_revision, uint64_t gas_limit, uint64_t* gas_used, SilkpreOutput* output) {
+    *output = {nullptr, 0};
+
+    if (contract->run == silkpre_expmod_run) {
+        // modexp: parse the header once for both gas and run
+        const ExpmodInput in{parse_expmod_input(input, len)};
+        const uint64_t gas{expmod_gas(in, evmc_revision)};
+        if (gas > gas_limit) {
+            *gas_used = gas_limit;
+            return SILKPRE_OUT_OF_GAS;
+        }
+        if (const auto hit{silkpre::prefetch::find(contract->index, input, len)}) {
+            return silkpre::replay_call(*hit, gas, gas_limit, gas_used, output);
+        }
+        silkpre::stats::Timer timer{contract->index, len};
+        const SilkpreOutput res{expmod_run(in)};
+        timer.stop(gas);
+        return finish(res, gas, gas_limit, gas_used, output);
+    }
+
+    const uint64_t gas{contract->gas(input, len, evmc_revision)};
+    if (gas > gas_limit) {
+        *gas_used = gas_limit;
+        return SILKPRE_OUT_OF_GAS;
+    }
+    if (const auto hit{silkpre::prefetch::find(contract->index, input, len)}) {
+        return silkpre::replay_call(*hit, gas, gas_limit, gas_used, output);
+    }
+    silkpre::stats::Timer timer{contract->index, len};
+    const SilkpreOutput res{contract->run(input, len)};
+    timer.stop(gas);
+    return finish(res, gas, gas_limit, gas_used, output);
+}
+
+SilkpreStatus silkpre_execute_view(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                                   int evmc_revision, uint64_t gas_limit, uint64_t* gas_used, SilkpreView* view) {
+    const uint64_t gas{contract->gas(input, len, evmc_revision)};
+    if (gas > gas_limit) {
+        *gas_used = gas_limit;
+        return SILKPRE_OUT_OF_GAS;
+    }
+    if (!contract->view(input, len, view)) {
+        *gas_used = gas_limit;
+        return SILKPRE_INVALID_INPUT;
+    }
+    *gas_used = gas;
+    return SILKPRE_SUCCESS;
+}
@@ -17,6 +17,7 @@
 #ifndef SILKPRE_PRECOMPILE_H_
 #define SILKPRE_PRECOMPILE_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -32,6 +33,19 @@ enum {
     SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS = 9,
 };
 
+enum { SILKPRE_P256VERIFY_ADDRESS = 0x100 };
+
+// All contracts implemented by Silkpre, including those outside of kSilkpreContracts
+enum { SILKPRE_NUMBER_OF_CONTRACTS = 10 };
+
+// Values of evmc_revision that change the set of precompiles or their gas rules
+enum {
+    SILKPRE_EVMC_FRONTIER = 0,
+    SILKPRE_EVMC_BYZANTIUM = 4,
+    SILKPRE_EVMC_ISTANBUL = 7,
+    SILKPRE_EVMC_BERLIN = 8,
+};
+
 typedef struct SilkpreOutput {
     uint8_t* data;  // Has to be freed if not NULL!!!
     size_t size;
@@ -40,6 +54,15 @@ typedef struct SilkpreOutput {
 typedef uint64_t (*SilkpreGasFunction)(const uint8_t* input, size_t len, int evmc_revision);
 typedef SilkpreOutput (*SilkpreRunFunction)(const uint8_t* input, size_t len);
 
+// Output borrowed from the input rather than allocated: valid as long as the input and never freed
+typedef struct SilkpreView {
+    const uint8_t* data;
+    size_t size;
+} SilkpreView;
+
+// Run function of a contract whose output is a slice of its input; returns false on failure
+typedef bool (*SilkpreViewFunction)(const uint8_t* input, size_t len, SilkpreView* view);
+
 typedef struct SilkpreContract {
     SilkpreGasFunction gas;
     SilkpreRunFunction run;
@@ -56,6 +79,7 @@ SilkpreOutput silkpre_rip160_run(const uint8_t* input, size_t len);
 
 uint64_t silkpre_id_gas(const uint8_t* input, size_t len, int evmc_revision);
 SilkpreOutput silkpre_id_run(const uint8_t* input, size_t len);
+bool silkpre_id_view(const uint8_t* input, size_t len, SilkpreView* view);
 
 // EIP-2565: ModExp Gas Cost
 uint64_t silkpre_expmod_gas(const uint8_t* input, size_t len, int evmc_revision);
@@ -78,8 +102,76 @@ SilkpreOutput silkpre_snarkv_run(const uint8_t* input, size_t len);
 uint64_t silkpre_blake2_f_gas(const uint8_t* input, size_t len, int evmc_revision);
 SilkpreOutput silkpre_blake2_f_run(const uint8_t* input, size_t len);
 
+// RIP-7212: Precompile for secp256r1 Curve Support
+uint64_t silkpre_p256verify_gas(const uint8_t* input, size_t len, int evmc_revision);
+SilkpreOutput silkpre_p256verify_run(const uint8_t* input, size_t len);
+
 extern const SilkpreContract kSilkpreContracts[SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS];
 
+enum {
+    SILKPRE_INIT_CPU = 1 << 0,        // CPU feature detection
+    SILKPRE_INIT_SECP256K1 = 1 << 1,  // silkpre_secp256k1_context and its precomputed tables
+    SILKPRE_INIT_BN254 = 1 << 2,      // alt_bn128 curve parameters and the comb table of the generator
+    SILKPRE_INIT_P256 = 1 << 3,       // secp256r1 table of multiples of the generator
+    SILKPRE_INIT_ALL = 0xf,
+};
+
+//! \brief Does up front the one-time setup otherwise done on first use, so that the first calls don't stall
+//! \param [in] flags : SILKPRE_INIT_* to set up; anything already set up is skipped
+//! Optional, idempotent and thread-safe.
+void silkpre_init(uint32_t flags);
+
+// Lives at SILKPRE_P256VERIFY_ADDRESS rather than in kSilkpreContracts
+extern const SilkpreContract kSilkpreP256VerifyContract;
+
+enum {
+    // Output depends on the input only
+    SILKPRE_CONTRACT_PURE = 1 << 0,
+};
+
+// New fields may only be appended.
+typedef struct SilkpreContractDescriptor {
+    SilkpreGasFunction gas;
+    SilkpreRunFunction run;
+    const char* name;
+    uint32_t address;          // the precompile address as a number
+    uint32_t index;            // dense index in [0, SILKPRE_NUMBER_OF_CONTRACTS)
+    size_t output_size;        // size of a successful output or 0 if it depends on the input
+    uint32_t flags;            // SILKPRE_CONTRACT_*
+    SilkpreViewFunction view;  // zero-copy alternative to run or NULL if the output isn't a slice of the input
+} SilkpreContractDescriptor;
+
+//! \brief Finds the precompile deployed at an address in a given revision
+//! \param [in] address : 20-byte address of the callee
+//! \param [in] evmc_revision : EVM revision; revisions after Berlin use the Berlin rules
+//! \return NULL if there is no precompile at the address.
+//! Contracts not activated by any Ethereum revision (e.g. RIP-7212 P256VERIFY) are never returned.
+const SilkpreContractDescriptor* silkpre_lookup(const uint8_t address[20], int evmc_revision);
+
+//! \brief Returns the descriptor with the given dense index or NULL if index >= SILKPRE_NUMBER_OF_CONTRACTS
+const SilkpreContractDescriptor* silkpre_contract_descriptor(size_t index);
+
+typedef enum SilkpreStatus {
+    SILKPRE_SUCCESS = 0,
+    SILKPRE_OUT_OF_GAS = 1,
+    SILKPRE_INVALID_INPUT = 2,
+    SILKPRE_NOT_A_PRECOMPILE = 3,  // only reported by silkpre_execute_batch
+    SILKPRE_BUDGET_EXCEEDED = 4,   // only reported by silkpre_execute_budget
+} SilkpreStatus;
+
+//! \brief Charges gas and runs a contract, parsing the input once
+//! \param [in] gas_limit : gas available to the call; more expensive calls are rejected before any heavy work
+//! \param [out] gas_used : gas charged; all of gas_limit unless the call succeeds
+//! \param [out] output : set on success only and has to be freed then
+SilkpreStatus silkpre_execute(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                              int evmc_revision, uint64_t gas_limit, uint64_t* gas_used, SilkpreOutput* output);
+
+//! \brief Same as silkpre_execute, but the output borrows from the input instead of being copied
+//! \param [in] contract : has to have a view function
+//! \param [out] view : set on success only
+SilkpreStatus silkpre_execute_view(const SilkpreContractDescriptor* contract, const uint8_t* input, size_t len,
+                                   int evmc_revision, uint64_t gas_limit, uint64_t* gas_used, SilkpreView* view);
+
 #if defined(__cplusplus)
 }
 #endif
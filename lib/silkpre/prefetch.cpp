@@ -0,0 +1,290 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "prefetch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(__APPLE__)
+#include <pthread/qos.h>
+#endif
+
+#include <silkpre/precompile.h>
+
+namespace {
+
+constexpr size_t kDefaultShards{16};
+
+using silkpre::CallResult;
+
+struct Hint {
+    uint32_t index;
+    std::basic_string<uint8_t> input;
+};
+
+void lower_priority() noexcept {
+#if defined(__linux__) && defined(SCHED_IDLE)
+    const sched_param param{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#endif
+}
+
+bool is_prefetched(size_t index) noexcept {
+    static const auto prefetched{[] {
+        std::array<bool, SILKPRE_NUMBER_OF_CONTRACTS> res{};
+        for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+            const SilkpreContractDescriptor& contract{*silkpre_contract_descriptor(i)};
+            res[i] = (contract.flags & SILKPRE_CONTRACT_PURE) && !silkpre::is_hash_like(contract);
+        }
+        return res;
+    }()};
+    return index < prefetched.size() && prefetched[index];
+}
+
+class Service {
+  public:
+    Service(size_t capacity_bytes, size_t max_pending, size_t num_workers)
+        : store{capacity_bytes, kDefaultShards}, max_pending_{max_pending} {
+        workers_.reserve(num_workers);
+        for (size_t i{0}; i < num_workers; ++i) {
+            workers_.emplace_back([this] {
+                lower_priority();
+                work();
+            });
+        }
+    }
+
+    Service(const Service&) = delete;
+    Service& operator=(const Service&) = delete;
+
+    bool push(Hint hint) {
+        {
+            std::lock_guard lock{mutex_};
+            if (pending_.size() >= max_pending_) {
+                ++dropped;
+                return false;
+            }
+            pending_.push_back(std::move(hint));
+            ++hints;
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    // Joins the workers; has to be called before the service is released
+    void shutdown() {
+        {
+            std::lock_guard lock{mutex_};
+            stop_ = true;
+            pending_.clear();
+        }
+        cv_.notify_all();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+        workers_.clear();
+    }
+
+    silkpre::CallStore store;
+    std::atomic<uint64_t> hints{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> over_gas{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+
+  private:
+    void work() {
+        for (;;) {
+            Hint hint;
+            {
+                std::unique_lock lock{mutex_};
+                cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                hint = std::move(pending_.front());
+                pending_.pop_front();
+            }
+            run(hint);
+        }
+    }
+
+    void run(const Hint& hint) {
+        const silkpre::CallKey key{silkpre::make_call_key(hint.index, hint.input.data(), hint.input.size())};
+        if (store.get(key)) {
+            return;  // already pre-executed, e.g. the same transaction seen from several peers
+        }
+        const SilkpreContractDescriptor& contract{*silkpre_contract_descriptor(hint.index)};
+        // No arena scope on this thread, so the output comes from malloc
+        const SilkpreOutput out{contract.run(hint.input.data(), hint.input.size())};
+        auto res{std::make_shared<CallResult>()};
+        res->success = out.data != nullptr;
+        if (res->success) {
+            res->bytes.assign(out.data, out.size);
+            std::free(out.data);
+        }
+        const size_t weight{silkpre::call_weight(*res)};
+        store.put(key, std::move(res), weight);
+        executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Hint> pending_;
+    size_t max_pending_;
+    bool stop_{false};
+    std::vector<std::thread> workers_;
+};
+
+// The service is published through an atomic pointer, so that lookups from the block import threads
+// don't serialize on a lock. Readers announce themselves in one of a few counters before loading it;
+// silkpre_prefetch_stop unpublishes the service and waits for the counters to drain before releasing it.
+constexpr size_t kReaderStripes{16};
+
+struct alignas(64) ReaderCount {
+    std::atomic<uint64_t> n{0};
+};
+
+std::atomic<Service*> service{nullptr};
+ReaderCount readers[kReaderStripes];
+std::mutex control_mutex;  // serializes start and stop
+std::atomic<uint64_t> max_gas{SILKPRE_PREFETCH_DEFAULT_MAX_GAS};
+
+ReaderCount& reader_count() noexcept {
+    thread_local ReaderCount& count{readers[std::hash<std::thread::id>{}(std::this_thread::get_id()) % kReaderStripes]};
+    return count;
+}
+
+// Keeps the published service, if any, alive for the lifetime of the reference
+class ServiceRef {
+  public:
+    ServiceRef() noexcept : count_{reader_count()} {
+        // Both sequentially consistent: either the exchange in silkpre_prefetch_stop comes first and
+        // the service is null, or the stop sees this reader and waits for it
+        count_.n.fetch_add(1);
+        service_ = service.load();
+    }
+
+    ~ServiceRef() { count_.n.fetch_sub(1, std::memory_order_release); }
+
+    ServiceRef(const ServiceRef&) = delete;
+    ServiceRef& operator=(const ServiceRef&) = delete;
+
+    explicit operator bool() const noexcept { return service_ != nullptr; }
+    Service* operator->() const noexcept { return service_; }
+
+  private:
+    ReaderCount& count_;
+    Service* service_;
+};
+
+}  // namespace
+
+namespace silkpre::prefetch {
+
+std::shared_ptr<const CallResult> find(uint32_t index, const uint8_t* input, size_t len) noexcept {
+    if (!service.load(std::memory_order_relaxed) || !is_prefetched(index)) {
+        return nullptr;
+    }
+    const ServiceRef s;
+    if (!s) {
+        return nullptr;
+    }
+    if (auto hit{s->store.get(make_call_key(index, input, len))}) {
+        s->hits.fetch_add(1, std::memory_order_relaxed);
+        return std::move(*hit);
+    }
+    s->misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+}  // namespace silkpre::prefetch
+
+bool silkpre_prefetch_start(size_t capacity_bytes, size_t max_pending, size_t num_workers) {
+    std::lock_guard lock{control_mutex};
+    if (service.load()) {
+        return false;
+    }
+    service.store(new Service{capacity_bytes, max_pending, std::max(num_workers, size_t{1})});
+    return true;
+}
+
+void silkpre_prefetch_stop(void) {
+    std::lock_guard lock{control_mutex};
+    Service* s{service.exchange(nullptr)};
+    if (!s) {
+        return;
+    }
+    for (const ReaderCount& r : readers) {
+        while (r.n.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+    s->shutdown();
+    delete s;
+}
+
+bool silkpre_prefetch_hint(const uint8_t address[20], const uint8_t* input, size_t len, int evmc_revision) {
+    if (!service.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const SilkpreContractDescriptor* contract{silkpre_lookup(address, evmc_revision)};
+    if (!contract || !is_prefetched(contract->index)) {
+        return false;
+    }
+    // The run functions count on the gas check for their bounds (e.g. modexp lengths)
+    const uint64_t gas{contract->gas(input, len, evmc_revision)};
+    const ServiceRef s;
+    if (!s) {
+        return false;
+    }
+    if (gas > max_gas.load(std::memory_order_relaxed)) {
+        s->over_gas.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return s->push(Hint{contract->index, std::basic_string<uint8_t>(input, len)});
+}
+
+void silkpre_prefetch_set_max_gas(uint64_t gas) { max_gas.store(gas, std::memory_order_relaxed); }
+
+void silkpre_prefetch_stats(SilkprePrefetchStats* stats) {
+    *stats = {};
+    if (const ServiceRef s; s) {
+        stats->hints = s->hints.load(std::memory_order_relaxed);
+        stats->dropped = s->dropped.load(std::memory_order_relaxed);
+        stats->over_gas = s->over_gas.load(std::memory_order_relaxed);
+        stats->executed = s->executed.load(std::memory_order_relaxed);
+        stats->hits = s->hits.load(std::memory_order_relaxed);
+        stats->misses = s->misses.load(std::memory_order_relaxed);
+    }
+}
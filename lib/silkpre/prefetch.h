@@ -0,0 +1,76 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_PREFETCH_H_
+#define SILKPRE_PREFETCH_H_
+
+// Speculative pre-execution of precompile calls seen ahead of time, e.g. in pending transactions.
+// Hinted calls run on low-priority background threads and their results are kept, so that
+// silkpre_execute of the same call later on (typically during block import) skips the run.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Default gas cap of the hinted calls: the mainnet block gas limit
+enum { SILKPRE_PREFETCH_DEFAULT_MAX_GAS = 30000000 };
+
+typedef struct SilkprePrefetchStats {
+    uint64_t hints;     // hints accepted
+    uint64_t dropped;   // hints rejected because too many were pending
+    uint64_t over_gas;  // hints rejected because they cost more than the gas cap
+    uint64_t executed;  // hinted calls run by the background threads
+    uint64_t hits;      // silkpre_execute calls served from pre-executed results
+    uint64_t misses;    // silkpre_execute calls of prefetched contracts that had to run
+} SilkprePrefetchStats;
+
+//! \brief Starts the process-wide pre-execution service
+//! \param [in] capacity_bytes : upper bound on the memory held by pre-executed results
+//! \param [in] max_pending : maximum number of hints waiting to run; further hints are dropped
+//! \param [in] num_workers : number of background threads; 0 for one
+//! \return false if the service is already running
+//! The workers run at the lowest scheduling priority (SCHED_IDLE on Linux, background QoS on macOS).
+//! The hash-like contracts (sha256, ripemd160, identity, blake2f) are never pre-executed.
+bool silkpre_prefetch_start(size_t capacity_bytes, size_t max_pending, size_t num_workers);
+
+//! \brief Stops the service, discarding pending hints and the pre-executed results
+//! Waits for the calls being pre-executed; a no-op if the service isn't running.
+void silkpre_prefetch_stop(void);
+
+//! \brief Queues a call for pre-execution without blocking; the input is copied
+//! \param [in] address : 20-byte address of the callee
+//! \param [in] evmc_revision : EVM revision the call is expected in
+//! \return false if the hint was ignored: the service isn't running, there is no prefetched contract
+//! at the address, the call costs more than the gas cap or too many hints are pending.
+//! The input is untrusted, so the gas of the call is checked before it is ever run.
+bool silkpre_prefetch_hint(const uint8_t address[20], const uint8_t* input, size_t len, int evmc_revision);
+
+//! \brief Hints of calls charged more than max_gas are dropped; SILKPRE_PREFETCH_DEFAULT_MAX_GAS by default
+//! Kept across restarts of the service; thread-safe.
+void silkpre_prefetch_set_max_gas(uint64_t max_gas);
+
+//! \brief Counters since the service was started; zeroed if it isn't running
+void silkpre_prefetch_stats(SilkprePrefetchStats* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_PREFETCH_H_
@@ -0,0 +1,35 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_PREFETCH_HPP_
+#define SILKPRE_PREFETCH_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include <silkpre/call_store.hpp>
+#include <silkpre/prefetch.h>
+
+namespace silkpre::prefetch {
+
+// Pre-executed result of the call, if any; cheap when the service isn't running
+std::shared_ptr<const CallResult> find(uint32_t index, const uint8_t* input, size_t len) noexcept;
+
+}  // namespace silkpre::prefetch
+
+#endif  // SILKPRE_PREFETCH_HPP_
@@ -38,6 +38,17 @@
 
 #include <string.h>
 
+#include <silkpre/cpu.h>
+#include <silkpre/dispatch.h>
+
+#if _MSC_VER
+#define ALWAYS_INLINE __forceinline
+#elif __has_attribute(always_inline)
+#define ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE
+#endif
+
 /********************************************************************/
 
 /* macro definitions */
@@ -130,7 +141,7 @@ static inline void rmd160_init(uint32_t* MDbuf) {
  *  the compression function.
  *  transforms MDbuf using message bytes X[0] through X[15]
  */
-static inline void rmd160_compress(uint32_t* MDbuf, const uint32_t* X) {
+static inline ALWAYS_INLINE void rmd160_compress(uint32_t* MDbuf, const uint32_t* X) {
     uint32_t aa = MDbuf[0], bb = MDbuf[1], cc = MDbuf[2], dd = MDbuf[3], ee = MDbuf[4];
     uint32_t aaa = MDbuf[0], bbb = MDbuf[1], ccc = MDbuf[2], ddd = MDbuf[3], eee = MDbuf[4];
 
@@ -329,7 +340,7 @@ static inline void rmd160_compress(uint32_t* MDbuf, const uint32_t* X) {
  *  note: length in bits == 8 * lswlen.
  *  note: there are (lswlen mod 64) bytes left in strptr.
  */
-static inline void rmd160_finish(uint32_t* MDbuf, uint8_t const* strptr, uint32_t lswlen) {
+static inline ALWAYS_INLINE void rmd160_finish(uint32_t* MDbuf, uint8_t const* strptr, uint32_t lswlen) {
     unsigned int i; /* counter       */
     uint32_t X[16]; /* message words */
 
@@ -362,7 +373,7 @@ static inline uint32_t load32(const void* src) {
     return w;
 }
 
-void silkpre_rmd160(uint8_t out[20], const uint8_t* ptr, size_t len) {
+static inline ALWAYS_INLINE void rmd160_implementation(uint8_t out[20], const uint8_t* ptr, size_t len) {
     uint32_t buf[160 / 32];
 
     rmd160_init(buf);
@@ -385,3 +396,35 @@ void silkpre_rmd160(uint8_t out[20], const uint8_t* ptr, size_t len) {
         out[i + 3] = buf[i >> 2] >> 24;
     }
 }
+
+static void rmd160_generic(uint8_t out[20], const uint8_t* ptr, size_t len) { rmd160_implementation(out, ptr, len); }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SILKPRE_RMD160_X86 1
+
+// Same code with RORX for the rotations
+__attribute__((target("bmi2"))) static void rmd160_bmi2(uint8_t out[20], const uint8_t* ptr, size_t len) {
+    rmd160_implementation(out, ptr, len);
+}
+#endif
+
+struct rmd160_kernel {
+    void (*fn)(uint8_t out[20], const uint8_t* ptr, size_t len);
+    const char* name;
+};
+
+static struct rmd160_kernel select_rmd160_kernel(uint32_t features) {
+#if defined(SILKPRE_RMD160_X86)
+    if (features & SILKPRE_CPU_BMI2) {
+        return (struct rmd160_kernel){rmd160_bmi2, "x86_bmi2"};
+    }
+#endif
+    (void)features;
+    return (struct rmd160_kernel){rmd160_generic, "generic"};
+}
+
+const char* silkpre_rmd160_kernel(uint32_t features) { return select_rmd160_kernel(features).name; }
+
+void silkpre_rmd160(uint8_t out[20], const uint8_t* ptr, size_t len) {
+    select_rmd160_kernel(silkpre_cpu_features()).fn(out, ptr, len);
+}
@@ -0,0 +1,69 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "secp256k1_context.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+#include <silkpre/ecdsa.h>
+
+namespace {
+
+std::atomic<bool> randomization{true};
+
+struct ThreadContext {
+    secp256k1_context* context{nullptr};
+
+    ~ThreadContext() {
+        if (context) {
+            secp256k1_context_destroy(context);
+        }
+    }
+};
+
+thread_local ThreadContext thread_context;
+
+}  // namespace
+
+const secp256k1_context* silkpre_secp256k1_context(void) {
+    // magic static; deliberately never destroyed since other threads may still be running at exit
+    static const secp256k1_context* context{secp256k1_context_create(SILKPRE_SECP256K1_CONTEXT_FLAGS)};
+    return context;
+}
+
+secp256k1_context* silkpre_secp256k1_thread_context(void) {
+    ThreadContext& tc{thread_context};
+    if (!tc.context) {
+        tc.context = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+        if (randomization.load(std::memory_order_relaxed)) {
+            std::random_device rd;
+            uint8_t seed[32];
+            for (size_t i{0}; i < sizeof(seed); i += 4) {
+                const uint32_t r{rd()};
+                for (size_t j{0}; j < 4; ++j) {
+                    seed[i + j] = static_cast<uint8_t>(r >> (8 * j));
+                }
+            }
+            // Can only fail for a context without SIGN
+            (void)secp256k1_context_randomize(tc.context, seed);
+        }
+    }
+    return tc.context;
+}
+
+void silkpre_secp256k1_set_randomization(bool enabled) { randomization.store(enabled, std::memory_order_relaxed); }
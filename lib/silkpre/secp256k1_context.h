@@ -0,0 +1,47 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_SECP256K1_CONTEXT_H_
+#define SILKPRE_SECP256K1_CONTEXT_H_
+
+// Library-managed secp256k1 contexts, so that callers don't have to create and share their own.
+
+#include <secp256k1.h>
+#include <stdbool.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! \brief Returns the library's context for public key recovery, verification and ECDH
+//! Built on first use (or by silkpre_init) and never modified afterwards,
+//! so any number of threads may use it at once without synchronization.
+const secp256k1_context* silkpre_secp256k1_context(void);
+
+//! \brief Returns the calling thread's signing context, destroyed when the thread exits
+//! The context is owned by a single thread, so it may be re-randomized with secp256k1_context_randomize
+//! without locking.
+secp256k1_context* silkpre_secp256k1_thread_context(void);
+
+//! \brief Sets whether thread contexts are randomized when created (the default) to blind signing against
+//! side channels; only affects threads that haven't created their context yet
+void silkpre_secp256k1_set_randomization(bool enabled);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_SECP256K1_CONTEXT_H_
@@ -0,0 +1,91 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "sender_cache.h"
+
+#include <array>
+#include <cstring>
+
+#include <silkpre/ecdsa.h>
+#include <silkpre/lru_cache.hpp>
+
+namespace {
+
+constexpr size_t kDefaultShards{16};
+
+// message hash | signature | y parity
+using Key = std::array<uint8_t, 32 + 64 + 1>;
+
+struct KeyHash {
+    size_t operator()(const Key& key) const noexcept {
+        // Mixing r in keeps different signatures of the same message apart
+        uint64_t h;
+        uint64_t r;
+        std::memcpy(&h, &key[0], sizeof(h));
+        std::memcpy(&r, &key[32], sizeof(r));
+        return static_cast<size_t>(h ^ r);
+    }
+};
+
+struct Sender {
+    bool valid;
+    std::array<uint8_t, 20> address;
+};
+
+}  // namespace
+
+struct SilkpreSenderCache {
+    SilkpreSenderCache(size_t capacity, size_t num_shards) : senders{capacity, num_shards} {}
+
+    silkpre::ShardedLruCache<Key, Sender, KeyHash> senders;
+};
+
+SilkpreSenderCache* silkpre_sender_cache_create(size_t capacity, size_t num_shards) {
+    return new SilkpreSenderCache{capacity, num_shards ? num_shards : kDefaultShards};
+}
+
+void silkpre_sender_cache_destroy(SilkpreSenderCache* cache) { delete cache; }
+
+bool silkpre_sender_cache_recover(SilkpreSenderCache* cache, uint8_t out[20], const uint8_t message[32],
+                                  const uint8_t signature[64], bool odd_y_parity) {
+    Key key;
+    std::memcpy(&key[0], message, 32);
+    std::memcpy(&key[32], signature, 64);
+    key[96] = odd_y_parity;
+
+    if (const auto hit{cache->senders.get(key)}) {
+        if (hit->valid) {
+            std::memcpy(out, hit->address.data(), 20);
+        }
+        return hit->valid;
+    }
+
+    Sender sender{};
+    sender.valid = silkpre_recover_address(sender.address.data(), message, signature, odd_y_parity, nullptr);
+    if (sender.valid) {
+        std::memcpy(out, sender.address.data(), 20);
+    }
+    cache->senders.put(key, sender);
+    return sender.valid;
+}
+
+void silkpre_sender_cache_stats(const SilkpreSenderCache* cache, SilkpreCacheStats* stats) {
+    const silkpre::LruCacheStats s{cache->senders.stats()};
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->insertions = s.insertions;
+    stats->evictions = s.evictions;
+}
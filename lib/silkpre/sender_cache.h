@@ -0,0 +1,54 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_SENDER_CACHE_H_
+#define SILKPRE_SENDER_CACHE_H_
+
+// Memoization of transaction sender recovery, so that a transaction seen twice
+// (mempool admission, then block import) is only recovered once.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <silkpre/cache.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct SilkpreSenderCache SilkpreSenderCache;
+
+//! \brief Creates a cache keyed by (message hash, signature, y parity)
+//! \param [in] capacity : maximum number of cached senders
+//! \param [in] num_shards : number of independently locked shards; 0 for the default
+SilkpreSenderCache* silkpre_sender_cache_create(size_t capacity, size_t num_shards);
+
+void silkpre_sender_cache_destroy(SilkpreSenderCache* cache);
+
+//! \brief Same as silkpre_recover_address with the library context, but skips the recovery when cached
+//! Failed recoveries are cached as well, so that resubmitted invalid signatures are cheap to reject.
+//! Thread-safe.
+bool silkpre_sender_cache_recover(SilkpreSenderCache* cache, uint8_t out[20], const uint8_t message[32],
+                                  const uint8_t signature[64], bool odd_y_parity);
+
+void silkpre_sender_cache_stats(const SilkpreSenderCache* cache, SilkpreCacheStats* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_SENDER_CACHE_H_
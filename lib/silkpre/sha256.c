@@ -21,24 +21,20 @@
 
 #include "sha256.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+#include <silkpre/cpu.h>
+#include <silkpre/dispatch.h>
+
 #if defined(__x86_64__)
 
-#include <cpuid.h>
 #include <x86intrin.h>
 
 #elif defined(__aarch64__) && defined(__APPLE__)
 
 #include <arm_neon.h>
 
-#if defined(__linux__)
-#include <asm/hwcap.h>
-#include <sys/auxv.h>
-#elif defined(__APPLE__)
-#include <sys/sysctl.h>
-#endif  // defined(__linux__), defined(__APPLE__)
-
 #endif  // defined(__x86_64__), defined(__aarch64__)
 
 #if _MSC_VER
@@ -71,14 +67,6 @@ static const uint32_t k[] = {
     0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
 
-struct buffer_state {
-    const uint8_t* p;
-    size_t len;
-    size_t total_len;
-    bool single_one_delivered;
-    bool total_len_delivered;
-};
-
 static inline uint32_t right_rot(uint32_t value, unsigned int count) {
     /*
      * Defined behaviour in standard C for all count where 0 < count < 32,
@@ -87,70 +75,22 @@ static inline uint32_t right_rot(uint32_t value, unsigned int count) {
     return value >> count | value << (32 - count);
 }
 
-static void init_buf_state(struct buffer_state* state, const void* input, size_t len) {
-    state->p = input;
-    state->len = len;
-    state->total_len = len;
-    state->single_one_delivered = false;
-    state->total_len_delivered = false;
-}
-
-static bool calc_chunk(uint8_t chunk[CHUNK_SIZE], struct buffer_state* state) {
-    if (state->total_len_delivered) {
-        return false;
-    }
-
-    if (state->len >= CHUNK_SIZE) {
-        memcpy(chunk, state->p, CHUNK_SIZE);
-        state->p += CHUNK_SIZE;
-        state->len -= CHUNK_SIZE;
-        return true;
-    }
+/*
+ * Initialize hash values:
+ * (first 32 bits of the fractional parts of the square roots of the first 8 primes 2..19):
+ */
+static const uint32_t initial_h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
 
-    memcpy(chunk, state->p, state->len);
-    chunk += state->len;
-    size_t space_in_chunk = CHUNK_SIZE - state->len;
-    if (state->len) {  // avoid adding 0 to nullptr
-        state->p += state->len;
-    }
-    state->len = 0;
+/*
+ * The second chunk of a 64-byte message: the single one bit, zeroes and the bit length 512.
+ */
+static const uint8_t padding_64[CHUNK_SIZE] = {0x80, [CHUNK_SIZE - 2] = 0x02};
 
-    /* If we are here, space_in_chunk is one at minimum. */
-    if (!state->single_one_delivered) {
-        *chunk++ = 0x80;
-        space_in_chunk -= 1;
-        state->single_one_delivered = true;
-    }
+// All kernels compress n whole chunks into h
+typedef void (*sha_256_compress)(uint32_t h[8], const uint8_t* chunks, size_t n);
 
-    /*
-     * Now:
-     * - either there is enough space left for the total length, and we can conclude,
-     * - or there is too little space left, and we have to pad the rest of this chunk with zeroes.
-     * In the latter case, we will conclude at the next invocation of this function.
-     */
-    if (space_in_chunk >= TOTAL_LEN_LEN) {
-        const size_t left = space_in_chunk - TOTAL_LEN_LEN;
-        size_t len = state->total_len;
-        int i;
-        memset(chunk, 0x00, left);
-        chunk += left;
-
-        /* Storing of len * 8 as a big endian 64-bit without overflow. */
-        chunk[7] = (uint8_t)(len << 3);
-        len >>= 5;
-        for (i = 6; i >= 0; i--) {
-            chunk[i] = (uint8_t)len;
-            len >>= 8;
-        }
-        state->total_len_delivered = true;
-    } else {
-        memset(chunk, 0x00, space_in_chunk);
-    }
-
-    return true;
-}
-
-static inline ALWAYS_INLINE void sha_256_implementation(uint32_t h[8], const void* input, size_t len) {
+static inline ALWAYS_INLINE void sha_256_implementation(uint32_t h[8], const uint8_t* chunks, size_t n) {
     /*
      * Note 1: All integers (expect indexes) are 32-bit unsigned integers and addition is calculated modulo 2^32.
      *
@@ -164,13 +104,8 @@ static inline ALWAYS_INLINE void sha_256_implementation(uint32_t h[8], const voi
      *     the first word of the input message "abc" after padding is 0x61626380
      */
 
-    struct buffer_state state;
-    init_buf_state(&state, input, len);
-
     /* 512-bit chunks is what we will operate on. */
-    uint8_t chunk[CHUNK_SIZE];
-
-    while (calc_chunk(chunk, &state)) {
+    for (; n; --n, chunks += CHUNK_SIZE) {
         unsigned i, j;
 
         uint32_t ah[8];
@@ -179,7 +114,7 @@ static inline ALWAYS_INLINE void sha_256_implementation(uint32_t h[8], const voi
             ah[i] = h[i];
         }
 
-        const uint8_t* p = chunk;
+        const uint8_t* p = chunks;
 
         /*
          * The w-array is really w[64], but since we only need
@@ -237,14 +172,12 @@ static inline ALWAYS_INLINE void sha_256_implementation(uint32_t h[8], const voi
     }
 }
 
-static void sha_256_generic(uint32_t h[8], const void* input, size_t len) { sha_256_implementation(h, input, len); }
-
-static void (*sha_256_best)(uint32_t h[8], const void* input, size_t len) = sha_256_generic;
+static void sha_256_generic(uint32_t h[8], const uint8_t* chunks, size_t n) { sha_256_implementation(h, chunks, n); }
 
 #if defined(__x86_64__)
 
-__attribute__((target("bmi,bmi2"))) static void sha_256_x86_bmi(uint32_t h[8], const void* input, size_t len) {
-    sha_256_implementation(h, input, len);
+__attribute__((target("bmi,bmi2"))) static void sha_256_x86_bmi(uint32_t h[8], const uint8_t* chunks, size_t n) {
+    sha_256_implementation(h, chunks, n);
 }
 
 #pragma GCC diagnostic push
@@ -255,7 +188,7 @@ __attribute__((target("bmi,bmi2"))) static void sha_256_x86_bmi(uint32_t h[8], c
 /*   Written and place in public domain by Jeffrey Walton  */
 /*   Based on code from Intel, and by Sean Gulley for      */
 /*   the miTLS project.                                    */
-__attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8], const void* input, size_t len) {
+__attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8], const uint8_t* chunks, size_t n) {
     __m128i STATE0, STATE1;
     __m128i MSG, TMP;
     __m128i MSG0, MSG1, MSG2, MSG3;
@@ -271,19 +204,14 @@ __attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8],
     STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);    /* ABEF */
     STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0); /* CDGH */
 
-    struct buffer_state state;
-    init_buf_state(&state, input, len);
-
     /* 512-bit chunks is what we will operate on. */
-    uint8_t chunk[CHUNK_SIZE];
-
-    while (calc_chunk(chunk, &state)) {
+    for (; n; --n, chunks += CHUNK_SIZE) {
         /* Save current state */
         ABEF_SAVE = STATE0;
         CDGH_SAVE = STATE1;
 
         /* Rounds 0-3 */
-        MSG = _mm_loadu_si128((const __m128i*)(chunk + 0));
+        MSG = _mm_loadu_si128((const __m128i*)(chunks + 0));
         MSG0 = _mm_shuffle_epi8(MSG, MASK);
         MSG = _mm_add_epi32(MSG0, _mm_set_epi64x(0xE9B5DBA5B5C0FBCFULL, 0x71374491428A2F98ULL));
         STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
@@ -291,7 +219,7 @@ __attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8],
         STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
 
         /* Rounds 4-7 */
-        MSG1 = _mm_loadu_si128((const __m128i*)(chunk + 16));
+        MSG1 = _mm_loadu_si128((const __m128i*)(chunks + 16));
         MSG1 = _mm_shuffle_epi8(MSG1, MASK);
         MSG = _mm_add_epi32(MSG1, _mm_set_epi64x(0xAB1C5ED5923F82A4ULL, 0x59F111F13956C25BULL));
         STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
@@ -300,7 +228,7 @@ __attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8],
         MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
 
         /* Rounds 8-11 */
-        MSG2 = _mm_loadu_si128((const __m128i*)(chunk + 32));
+        MSG2 = _mm_loadu_si128((const __m128i*)(chunks + 32));
         MSG2 = _mm_shuffle_epi8(MSG2, MASK);
         MSG = _mm_add_epi32(MSG2, _mm_set_epi64x(0x550C7DC3243185BEULL, 0x12835B01D807AA98ULL));
         STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
@@ -309,7 +237,7 @@ __attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8],
         MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
 
         /* Rounds 12-15 */
-        MSG3 = _mm_loadu_si128((const __m128i*)(chunk + 48));
+        MSG3 = _mm_loadu_si128((const __m128i*)(chunks + 48));
         MSG3 = _mm_shuffle_epi8(MSG3, MASK);
         MSG = _mm_add_epi32(MSG3, _mm_set_epi64x(0xC19BF1749BDC06A7ULL, 0x80DEB1FE72BE5D74ULL));
         STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
@@ -451,37 +379,6 @@ __attribute__((target("sha,sse4.1"))) static void sha_256_x86_sha(uint32_t h[8],
 
 #pragma GCC diagnostic pop
 
-// https://stackoverflow.com/questions/6121792/how-to-check-if-a-cpu-supports-the-sse3-instruction-set
-void cpuid(int info[4], int InfoType) { __cpuid_count(InfoType, 0, info[0], info[1], info[2], info[3]); }
-
-__attribute__((constructor)) static void select_sha256_implementation() {
-    int info[4];
-    cpuid(info, 0);
-    int nIds = info[0];
-
-    bool hw_sse41 = false;
-    bool hw_bmi1 = false;
-    bool hw_bmi2 = false;
-    bool hw_sha = false;
-
-    if (nIds >= 0x00000001) {
-        cpuid(info, 0x00000001);
-        hw_sse41 = (info[2] & ((int)1 << 19)) != 0;
-    }
-    if (nIds >= 0x00000007) {
-        cpuid(info, 0x00000007);
-        hw_bmi1 = (info[1] & ((int)1 << 3)) != 0;
-        hw_bmi2 = (info[1] & ((int)1 << 8)) != 0;
-        hw_sha = (info[1] & ((int)1 << 29)) != 0;
-    }
-
-    if (hw_sse41 && hw_sha) {
-        sha_256_best = sha_256_x86_sha;
-    } else if (hw_bmi1 && hw_bmi2) {
-        sha_256_best = sha_256_x86_bmi;
-    }
-}
-
 #elif defined(__aarch64__) && defined(__APPLE__)
 
 // The following function was adapted from https://github.com/noloader/SHA-Intrinsics/blob/master/sha256-arm.c
@@ -489,7 +386,7 @@ __attribute__((constructor)) static void select_sha256_implementation() {
 /*   Written and placed in public domain by Jeffrey Walton    */
 /*   Based on code from ARM, and by Johannes Schneiders, Skip */
 /*   Hovsmith and Barry O'Rourke for the mbedTLS project.     */
-static void sha_256_arm_v8(uint32_t h[8], const void* input, size_t len) {
+static void sha_256_arm_v8(uint32_t h[8], const uint8_t* chunks, size_t n) {
     uint32x4_t STATE0, STATE1, ABEF_SAVE, CDGH_SAVE;
     uint32x4_t MSG0, MSG1, MSG2, MSG3;
     uint32x4_t TMP0, TMP1, TMP2;
@@ -498,22 +395,17 @@ static void sha_256_arm_v8(uint32_t h[8], const void* input, size_t len) {
     STATE0 = vld1q_u32(&h[0]);
     STATE1 = vld1q_u32(&h[4]);
 
-    struct buffer_state state;
-    init_buf_state(&state, input, len);
-
     /* 512-bit chunks is what we will operate on. */
-    uint8_t chunk[CHUNK_SIZE];
-
-    while (calc_chunk(chunk, &state)) {
+    for (; n; --n, chunks += CHUNK_SIZE) {
         /* Save state */
         ABEF_SAVE = STATE0;
         CDGH_SAVE = STATE1;
 
         /* Load message */
-        MSG0 = vld1q_u32((const uint32_t*)(chunk + 0));
-        MSG1 = vld1q_u32((const uint32_t*)(chunk + 16));
-        MSG2 = vld1q_u32((const uint32_t*)(chunk + 32));
-        MSG3 = vld1q_u32((const uint32_t*)(chunk + 48));
+        MSG0 = vld1q_u32((const uint32_t*)(chunks + 0));
+        MSG1 = vld1q_u32((const uint32_t*)(chunks + 16));
+        MSG2 = vld1q_u32((const uint32_t*)(chunks + 32));
+        MSG3 = vld1q_u32((const uint32_t*)(chunks + 48));
 
         /* Reverse for little endian */
         MSG0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG0)));
@@ -652,25 +544,53 @@ static void sha_256_arm_v8(uint32_t h[8], const void* input, size_t len) {
     vst1q_u32(&h[4], STATE1);
 }
 
-__attribute__((constructor)) static void select_sha256_implementation() {
-#if defined(__linux__)
-    if ((getauxval(AT_HWCAP) & HWCAP_SHA2) != 0) {
-        sha_256_best = sha_256_arm_v8;
+#endif  // defined(__x86_64__), defined(__aarch64__)
+
+struct sha_256_kernel {
+    sha_256_compress fn;
+    const char* name;
+};
+
+static struct sha_256_kernel select_sha_256_kernel(uint32_t features) {
+#if defined(__x86_64__)
+    if (features & SILKPRE_CPU_SHA) {
+        return (struct sha_256_kernel){sha_256_x86_sha, "x86_sha"};
     }
-#elif defined(__APPLE__)
-    int64_t hw_cap = 0;
-    size_t size = sizeof(hw_cap);
-
-    if (sysctlbyname("hw.optional.armv8_2_sha3", &hw_cap, &size, NULL, 0) == 0) {
-        // Use SHA3 as proxy for SHA2 (sysctl hw doesn't list SHA2 for Apple M1)
-        if (hw_cap == 1) {
-            sha_256_best = sha_256_arm_v8;
-        }
+    if (features & SILKPRE_CPU_BMI2) {
+        return (struct sha_256_kernel){sha_256_x86_bmi, "x86_bmi2"};
+    }
+#elif defined(__aarch64__) && defined(__APPLE__)
+    if (features & SILKPRE_CPU_ARM_SHA2) {
+        return (struct sha_256_kernel){sha_256_arm_v8, "arm_v8"};
     }
-#endif  // defined(__linux__), defined(__APPLE__)
+#endif
+    (void)features;
+    return (struct sha_256_kernel){sha_256_generic, "generic"};
 }
 
-#endif  // defined(__x86_64__), defined(__aarch64__)
+const char* silkpre_sha256_kernel(uint32_t features) { return select_sha_256_kernel(features).name; }
+
+static struct sha_256_kernel sha_256_kernel(bool use_cpu_extensions) {
+    return select_sha_256_kernel(use_cpu_extensions ? silkpre_cpu_features() : 0);
+}
+
+/* Produce the final hash value (big-endian): */
+static void store_hash(uint8_t hash[32], const uint32_t h[8]) {
+    for (unsigned i = 0, j = 0; i < 8; i++) {
+        hash[j++] = (uint8_t)(h[i] >> 24);
+        hash[j++] = (uint8_t)(h[i] >> 16);
+        hash[j++] = (uint8_t)(h[i] >> 8);
+        hash[j++] = (uint8_t)h[i];
+    }
+}
+
+static void sha_256_64(const struct sha_256_kernel* kernel, uint8_t hash[32], const uint8_t input[64]) {
+    uint32_t h[8];
+    memcpy(h, initial_h, sizeof(h));
+    kernel->fn(h, input, 1);
+    kernel->fn(h, padding_64, 1);
+    store_hash(hash, h);
+}
 
 /*
  * Limitations:
@@ -681,23 +601,91 @@ __attribute__((constructor)) static void select_sha256_implementation() {
  *   In particular, the len parameter is a number of bytes.
  */
 void silkpre_sha256(uint8_t hash[32], const uint8_t* input, size_t len, bool use_cpu_extensions) {
+    const struct sha_256_kernel kernel = sha_256_kernel(use_cpu_extensions);
+    if (len == 64) {
+        sha_256_64(&kernel, hash, input);
+        return;
+    }
+
+    uint32_t h[8];
+    memcpy(h, initial_h, sizeof(h));
+
+    /* Whole chunks are compressed straight from the input, */
+    const size_t full = len / CHUNK_SIZE;
+    if (full) {
+        kernel.fn(h, input, full);
+    }
+
     /*
-     * Initialize hash values:
-     * (first 32 bits of the fractional parts of the square roots of the first 8 primes 2..19):
+     * and the rest is padded with the single one bit, zeroes and the bit length into one or two chunks,
+     * depending on whether the length still fits into the first one.
      */
-    uint32_t h[] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t tail[2 * CHUNK_SIZE] = {0};
+    const size_t rem = len % CHUNK_SIZE;
+    if (rem) {
+        memcpy(tail, input + full * CHUNK_SIZE, rem);
+    }
+    tail[rem] = 0x80;
+    const size_t tail_len = rem + 1 + TOTAL_LEN_LEN <= CHUNK_SIZE ? CHUNK_SIZE : 2 * CHUNK_SIZE;
+
+    /* Storing of len * 8 as a big endian 64-bit without overflow. */
+    uint8_t* p = tail + tail_len - TOTAL_LEN_LEN;
+    p[7] = (uint8_t)(len << 3);
+    len >>= 5;
+    for (int i = 6; i >= 0; i--) {
+        p[i] = (uint8_t)len;
+        len >>= 8;
+    }
+    kernel.fn(h, tail, tail_len / CHUNK_SIZE);
+
+    store_hash(hash, h);
+}
+
+void silkpre_sha256_64(uint8_t hash[32], const uint8_t input[64], bool use_cpu_extensions) {
+    const struct sha_256_kernel kernel = sha_256_kernel(use_cpu_extensions);
+    sha_256_64(&kernel, hash, input);
+}
 
-    if (use_cpu_extensions) {
-        sha_256_best(h, input, len);
-    } else {
-        sha_256_generic(h, input, len);
+// Hashes a layer of m nodes into the (m + 1) / 2 nodes of the layer above; out may be the same as in.
+// An odd last node is paired with zero, the root of an all-zero subtree of the same height.
+static void hash_layer(const struct sha_256_kernel* kernel, uint8_t* out, const uint8_t* in, size_t m,
+                       const uint8_t zero[32]) {
+    for (size_t i = 0; i < m / 2; i++) {
+        sha_256_64(kernel, out + 32 * i, in + 64 * i);
     }
+    if (m % 2) {
+        uint8_t pair[64];
+        memcpy(pair, in + 32 * (m - 1), 32);
+        memcpy(pair + 32, zero, 32);
+        sha_256_64(kernel, out + 32 * (m / 2), pair);
+    }
+}
 
-    /* Produce the final hash value (big-endian): */
-    for (unsigned i = 0, j = 0; i < 8; i++) {
-        hash[j++] = (uint8_t)(h[i] >> 24);
-        hash[j++] = (uint8_t)(h[i] >> 16);
-        hash[j++] = (uint8_t)(h[i] >> 8);
-        hash[j++] = (uint8_t)h[i];
+bool silkpre_sha256_merkleize(uint8_t root[32], const uint8_t* leaves, size_t n, bool use_cpu_extensions) {
+    if (n <= 1) {
+        if (n) {
+            memcpy(root, leaves, 32);
+        } else {
+            memset(root, 0, 32);
+        }
+        return true;
     }
+
+    const struct sha_256_kernel kernel = sha_256_kernel(use_cpu_extensions);
+    uint8_t* layer = malloc(32 * ((n + 1) / 2));
+    if (!layer) {
+        return false;
+    }
+
+    uint8_t zero[64] = {0};
+    hash_layer(&kernel, layer, leaves, n, zero);
+    for (size_t m = (n + 1) / 2; m > 1; m = (m + 1) / 2) {
+        memcpy(zero + 32, zero, 32);
+        sha_256_64(&kernel, zero, zero);
+        hash_layer(&kernel, layer, layer, m, zero);
+    }
+
+    memcpy(root, layer, 32);
+    free(layer);
+    return true;
 }
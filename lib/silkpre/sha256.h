@@ -27,6 +27,16 @@ extern "C" {
 
 void silkpre_sha256(uint8_t hash[32], const uint8_t* input, size_t len, bool use_cpu_extensions);
 
+//! \brief Same as silkpre_sha256 for exactly 64 bytes, e.g. two concatenated 32-byte Merkle nodes
+void silkpre_sha256_64(uint8_t hash[32], const uint8_t input[64], bool use_cpu_extensions);
+
+//! \brief Computes the root of the binary Merkle tree whose nodes are the SHA-256 of their two children.
+//! As in SSZ, the leaves are padded with zeroes to the next power of two; the root of a single leaf is the leaf
+//! itself and the root of no leaves is zero.
+//! \param [in] leaves : n 32-byte leaves
+//! \return false if the memory for the layers couldn't be allocated
+bool silkpre_sha256_merkleize(uint8_t root[32], const uint8_t* leaves, size_t n, bool use_cpu_extensions);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,144 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stats.h"
+
+#include <cstring>
+
+#if defined(SILKPRE_STATS)
+
+#include <atomic>
+
+#include <intx/intx.hpp>
+
+#include <silkpre/stats.hpp>
+
+namespace {
+
+// Each thread owns a block of counters that only it writes, so increments are plain relaxed
+// load/store pairs. Blocks are linked into a global list that readers walk without locking;
+// they are never freed but get reused by new threads once their owner has exited.
+struct Counters {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> total_ns;
+    std::atomic<uint64_t> total_cycles;
+    std::atomic<uint64_t> total_gas;
+    std::atomic<uint64_t> input_size[SILKPRE_STATS_BUCKETS];
+    std::atomic<uint64_t> ns[SILKPRE_STATS_BUCKETS];
+    std::atomic<uint64_t> mgas_per_s[SILKPRE_STATS_BUCKETS];
+};
+
+struct Block {
+    Counters contracts[SILKPRE_NUMBER_OF_CONTRACTS]{};
+    Block* next{nullptr};
+    std::atomic<bool> in_use{true};
+};
+
+std::atomic<Block*> g_blocks{nullptr};
+
+Block* acquire_block() {
+    for (Block* b{g_blocks.load(std::memory_order_acquire)}; b; b = b->next) {
+        bool in_use{false};
+        if (b->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+            return b;
+        }
+    }
+    auto* b{new Block};
+    b->next = g_blocks.load(std::memory_order_relaxed);
+    while (!g_blocks.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return b;
+}
+
+struct ThreadBlock {
+    Block* block{acquire_block()};
+    ~ThreadBlock() { block->in_use.store(false, std::memory_order_release); }
+};
+
+thread_local ThreadBlock t_block;
+
+struct Charge {
+    size_t index;
+    uint64_t gas;
+};
+
+thread_local Charge t_charge{SILKPRE_NUMBER_OF_CONTRACTS, 0};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t delta) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+inline size_t bucket(uint64_t v) noexcept {
+    const size_t width{static_cast<size_t>(64 - intx::clz(v))};
+    return width < SILKPRE_STATS_BUCKETS ? width : SILKPRE_STATS_BUCKETS - 1;
+}
+
+}  // namespace
+
+namespace silkpre::stats {
+
+void charged(size_t index, uint64_t gas) noexcept { t_charge = {index, gas}; }
+
+uint64_t take_charged(size_t index) noexcept {
+    const Charge c{t_charge};
+    t_charge.index = SILKPRE_NUMBER_OF_CONTRACTS;
+    return c.index == index ? c.gas : 0;
+}
+
+void record(size_t index, size_t input_size, uint64_t gas, uint64_t ns, uint64_t cycles) noexcept {
+    Counters& c{t_block.block->contracts[index]};
+    bump(c.calls, 1);
+    bump(c.total_ns, ns);
+    bump(c.total_cycles, cycles);
+    bump(c.total_gas, gas);
+    bump(c.input_size[bucket(input_size)], 1);
+    bump(c.ns[bucket(ns)], 1);
+    if (gas) {
+        const uint64_t mgas_per_s{gas < UINT64_MAX / 1000 ? gas * 1000 / (ns ? ns : 1) : UINT64_MAX};
+        bump(c.mgas_per_s[bucket(mgas_per_s)], 1);
+    }
+}
+
+}  // namespace silkpre::stats
+
+bool silkpre_stats_snapshot(SilkpreStats* stats) {
+    std::memset(stats, 0, sizeof(*stats));
+    for (const Block* b{g_blocks.load(std::memory_order_acquire)}; b; b = b->next) {
+        for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+            const Counters& c{b->contracts[i]};
+            SilkpreContractStats& s{stats->contracts[i]};
+            s.calls += c.calls.load(std::memory_order_relaxed);
+            s.total_ns += c.total_ns.load(std::memory_order_relaxed);
+            s.total_cycles += c.total_cycles.load(std::memory_order_relaxed);
+            s.total_gas += c.total_gas.load(std::memory_order_relaxed);
+            for (size_t k{0}; k < SILKPRE_STATS_BUCKETS; ++k) {
+                s.input_size[k] += c.input_size[k].load(std::memory_order_relaxed);
+                s.ns[k] += c.ns[k].load(std::memory_order_relaxed);
+                s.mgas_per_s[k] += c.mgas_per_s[k].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return true;
+}
+
+#else
+
+bool silkpre_stats_snapshot(SilkpreStats* stats) {
+    std::memset(stats, 0, sizeof(*stats));
+    return false;
+}
+
+#endif  // SILKPRE_STATS
@@ -0,0 +1,60 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_STATS_H_
+#define SILKPRE_STATS_H_
+
+// Per-contract performance counters, compiled in with the SILKPRE_STATS CMake option.
+// Calls through kSilkpreContracts, kSilkpreP256VerifyContract and silkpre_execute are recorded.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <silkpre/precompile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Histogram bucket i counts values v with bit_width(v) == i, i.e. bucket 0 is v == 0
+// and bucket i > 0 covers [2^(i-1), 2^i); the last bucket also takes everything above.
+enum { SILKPRE_STATS_BUCKETS = 64 };
+
+typedef struct SilkpreContractStats {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t total_cycles;  // TSC or the virtual counter; 0 where unavailable
+    uint64_t total_gas;     // only for calls whose gas was charged through Silkpre on the same thread
+    uint64_t input_size[SILKPRE_STATS_BUCKETS];
+    uint64_t ns[SILKPRE_STATS_BUCKETS];
+    uint64_t mgas_per_s[SILKPRE_STATS_BUCKETS];  // gas per nanosecond × 1000
+} SilkpreContractStats;
+
+typedef struct SilkpreStats {
+    SilkpreContractStats contracts[SILKPRE_NUMBER_OF_CONTRACTS];  // by SilkpreContractDescriptor::index
+} SilkpreStats;
+
+//! \brief Sums the counters of all threads, past and present
+//! \return false if Silkpre was built without SILKPRE_STATS; *stats is zeroed then.
+//! Counters are read while other threads may be updating them, so the sums of a busy
+//! process are approximate (but never torn per counter).
+bool silkpre_stats_snapshot(SilkpreStats* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // SILKPRE_STATS_H_
@@ -0,0 +1,95 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_STATS_HPP_
+#define SILKPRE_STATS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(SILKPRE_STATS)
+
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#endif
+
+namespace silkpre::stats {
+
+#if defined(SILKPRE_STATS)
+
+inline uint64_t cycles() noexcept {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return 0;
+#endif
+}
+
+inline uint64_t now_ns() noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+// Remembers the gas just charged on this thread so that the following run can be attributed it
+void charged(size_t index, uint64_t gas) noexcept;
+
+// Returns the gas charged on this thread to the contract since the last call, if any, or 0
+uint64_t take_charged(size_t index) noexcept;
+
+void record(size_t index, size_t input_size, uint64_t gas, uint64_t ns, uint64_t cycles) noexcept;
+
+class Timer {
+  public:
+    Timer(size_t index, size_t input_size) noexcept
+        : index_{index}, input_size_{input_size}, cycles_{cycles()}, ns_{now_ns()} {}
+
+    void stop(uint64_t gas) noexcept {
+        const uint64_t ns{now_ns() - ns_};
+        record(index_, input_size_, gas, ns, cycles() - cycles_);
+    }
+
+  private:
+    size_t index_;
+    size_t input_size_;
+    uint64_t cycles_;
+    uint64_t ns_;
+};
+
+#else
+
+// Compiled out
+class Timer {
+  public:
+    Timer(size_t, size_t) noexcept {}
+    void stop(uint64_t) noexcept {}
+};
+
+#endif  // SILKPRE_STATS
+
+}  // namespace silkpre::stats
+
+#endif  // SILKPRE_STATS_HPP_
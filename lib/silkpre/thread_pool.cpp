@@ -0,0 +1,72 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace silkpre {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    threads_.reserve(num_threads);
+    for (size_t i{0}; i < num_threads; ++i) {
+        threads_.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    // magic static; deliberately never destroyed so that no thread is joined during static destruction
+    static ThreadPool* pool{new ThreadPool{std::max(2u, std::thread::hardware_concurrency()) - 1}};
+    return *pool;
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    {
+        std::lock_guard lock{mutex_};
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex_};
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace silkpre
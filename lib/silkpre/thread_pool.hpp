@@ -0,0 +1,60 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_THREAD_POOL_HPP_
+#define SILKPRE_THREAD_POOL_HPP_
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace silkpre {
+
+// Fixed set of worker threads running posted tasks in FIFO order
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool of hardware_concurrency - 1 workers (at least 1), created on first use;
+    // callers are expected to work alongside it.
+    static ThreadPool& instance();
+
+    void post(std::function<void()> task);
+
+    size_t size() const noexcept { return threads_.size(); }
+
+  private:
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_{false};
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace silkpre
+
+#endif  // SILKPRE_THREAD_POOL_HPP_
@@ -0,0 +1,110 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/arena.h>
+#include <silkpre/precompile.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+TEST_CASE("Arena allocation") {
+    SilkpreArena* arena{silkpre_arena_create(/*block_size=*/256)};
+
+    auto* a{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 3))};
+    auto* b{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 0))};
+    auto* c{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 40))};
+    REQUIRE((a && b && c));
+    CHECK(reinterpret_cast<uintptr_t>(a) % 16 == 0);
+    CHECK(b == a + 16);
+    CHECK(c == b + 16);
+    CHECK(silkpre_arena_used(arena) == 80);
+
+    // Spills into a second block, then an outsized allocation gets its own
+    auto* d{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 64))};
+    auto* e{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 64))};
+    auto* f{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 64))};
+    auto* big{static_cast<uint8_t*>(silkpre_arena_alloc(arena, 1000))};
+    REQUIRE((d && e && f && big));
+    CHECK(d == c + 48);
+    CHECK(e == d + 64);
+    CHECK(f != e + 64);
+    std::memset(big, 0xff, 1000);
+    CHECK(silkpre_arena_used(arena) == 80 + 3 * 64 + 1008);
+
+    // Blocks are reused in order after a reset
+    silkpre_arena_reset(arena);
+    CHECK(silkpre_arena_used(arena) == 0);
+    CHECK(silkpre_arena_alloc(arena, 64) == a);
+    for (int i{0}; i < 3; ++i) {
+        CHECK(silkpre_arena_alloc(arena, 64));
+    }
+    CHECK(silkpre_arena_alloc(arena, 64) == f);
+
+    silkpre_arena_destroy(arena);
+}
+
+TEST_CASE("Arena outputs") {
+    SilkpreArena* arena{silkpre_arena_create(0)};
+
+    const std::basic_string<uint8_t> inputs[SILKPRE_NUMBER_OF_CONTRACTS]{
+        ecrec_input(),
+        random_bytes(100),
+        random_bytes(100),
+        random_bytes(100),
+        expmod_input(64, from_hex("010001"), 64, /*odd_modulus=*/true),
+        bn_add_input(),
+        bn_mul_input(),
+        snarkv_input(1),
+        blake2_f_input(12),
+        p256verify_input(),
+    };
+    for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+        const SilkpreContractDescriptor* contract{silkpre_contract_descriptor(i)};
+        const std::basic_string<uint8_t>& in{inputs[i]};
+        SilkpreOutput expected{contract->run(in.data(), in.length())};
+        REQUIRE(expected.data);
+        const size_t used{silkpre_arena_used(arena)};
+        const SilkpreOutput out{silkpre_arena_run(arena, contract->run, in.data(), in.length())};
+        REQUIRE(out.data);
+        CHECK(silkpre_arena_used(arena) > used);
+        CHECK(to_hex(out.data, out.size) == to_hex(expected.data, expected.size));
+        std::free(expected.data);
+    }
+
+    const std::basic_string<uint8_t> in{random_bytes(100)};
+    // Outside of the arena outputs are malloc'ed again
+    const SilkpreContractDescriptor* identity{silkpre_contract_descriptor(3)};
+    SilkpreOutput out{identity->run(in.data(), in.length())};
+    REQUIRE(out.data);
+    std::free(out.data);
+
+    uint64_t gas_used;
+    const size_t used{silkpre_arena_used(arena)};
+    REQUIRE(silkpre_execute_arena(arena, identity, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 1'000, &gas_used,
+                                  &out) == SILKPRE_SUCCESS);
+    CHECK(gas_used == 15 + 3 * 4);
+    CHECK(to_hex(out.data, out.size) == to_hex(in.data(), in.length()));
+    CHECK(silkpre_arena_used(arena) == used + 112);
+
+    silkpre_arena_destroy(arena);
+}
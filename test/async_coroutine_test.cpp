@@ -0,0 +1,89 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Built as C++20 on its own, the library and the other tests being C++17
+
+#include <coroutine>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/async.h>
+#include <silkpre/async.hpp>
+#include <silkpre/precompile.h>
+#include <silkpre/sha256.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+namespace {
+
+// Minimal eager coroutine type, just enough to co_await in
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::abort(); }
+    };
+};
+
+Task hash_twice(SilkpreQueue* queue, const std::basic_string<uint8_t>& in, std::string& out) {
+    const SilkpreSubmission s{0, silkpre_contract_descriptor(1), in.data(), in.length(), SILKPRE_EVMC_BERLIN, 1'000};
+    SilkpreCompletion first{co_await silkpre::AsyncCall{queue, s}};
+    const std::basic_string<uint8_t> digest(first.output.data, first.output.size);
+    std::free(first.output.data);
+
+    const SilkpreSubmission s2{0, s.contract, digest.data(), digest.length(), SILKPRE_EVMC_BERLIN, 1'000};
+    SilkpreCompletion second{co_await silkpre::AsyncCall{queue, s2}};
+    out = to_hex(second.output.data, second.output.size);
+    std::free(second.output.data);
+}
+
+}  // namespace
+
+TEST_CASE("Async coroutine") {
+    SilkpreQueue* queue{silkpre_queue_create(0)};
+
+    std::vector<std::string> outputs(8);
+    std::vector<std::basic_string<uint8_t>> inputs;
+    for (size_t i{0}; i < outputs.size(); ++i) {
+        inputs.push_back(random_bytes(100, i));
+    }
+    for (size_t i{0}; i < outputs.size(); ++i) {
+        hash_twice(queue, inputs[i], outputs[i]);
+    }
+    // Event loop
+    while (silkpre_queue_in_flight(queue)) {
+        SilkpreCompletion c;
+        if (silkpre_queue_wait(queue, &c, 1, 1)) {
+            silkpre::resume(c);
+        }
+    }
+
+    for (size_t i{0}; i < outputs.size(); ++i) {
+        uint8_t digest[32];
+        silkpre_sha256(digest, inputs[i].data(), inputs[i].length(), true);
+        uint8_t expected[32];
+        silkpre_sha256(expected, digest, 32, true);
+        CHECK(outputs[i] == to_hex(expected, 32));
+    }
+
+    silkpre_queue_destroy(queue);
+}
@@ -0,0 +1,100 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/async.h>
+#include <silkpre/precompile.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+TEST_CASE("Async queue") {
+    SilkpreQueue* queue{silkpre_queue_create(0)};
+
+    std::vector<std::basic_string<uint8_t>> inputs;
+    std::vector<SilkpreSubmission> submissions;
+    for (size_t i{0}; i < 100; ++i) {
+        inputs.push_back(random_bytes(i * 10, i));
+    }
+    for (size_t i{0}; i < inputs.size(); ++i) {
+        // sha256, ripemd160 and identity
+        const SilkpreContractDescriptor* contract{silkpre_contract_descriptor(1 + i % 3)};
+        submissions.push_back({i, contract, inputs[i].data(), inputs[i].length(), SILKPRE_EVMC_BERLIN, 1'000'000});
+    }
+    submissions[7].gas_limit = 1;
+    REQUIRE(silkpre_queue_submit(queue, submissions.data(), submissions.size()) == submissions.size());
+
+    std::vector<bool> seen(submissions.size());
+    size_t reaped{0};
+    while (reaped < submissions.size()) {
+        SilkpreCompletion completions[16];
+        const size_t n{silkpre_queue_wait(queue, completions, 16, 1)};
+        REQUIRE(n > 0);
+        for (size_t i{0}; i < n; ++i) {
+            const SilkpreCompletion& c{completions[i]};
+            REQUIRE(c.user_data < submissions.size());
+            CHECK(!seen[c.user_data]);
+            seen[c.user_data] = true;
+
+            const SilkpreSubmission& s{submissions[c.user_data]};
+            uint64_t gas_used;
+            SilkpreOutput expected;
+            const SilkpreStatus status{silkpre_execute(s.contract, s.input, s.input_len, s.evmc_revision,
+                                                       s.gas_limit, &gas_used, &expected)};
+            CHECK(c.status == status);
+            CHECK(c.gas_used == gas_used);
+            if (status == SILKPRE_SUCCESS) {
+                CHECK(to_hex(c.output.data, c.output.size) == to_hex(expected.data, expected.size));
+            }
+            std::free(expected.data);
+            std::free(c.output.data);
+        }
+        reaped += n;
+    }
+    CHECK(silkpre_queue_in_flight(queue) == 0);
+
+    SilkpreCompletion c;
+    CHECK(silkpre_queue_reap(queue, &c, 1) == 0);
+    CHECK(silkpre_queue_wait(queue, &c, 1, 1) == 0);  // nothing in flight
+
+    silkpre_queue_destroy(queue);
+}
+
+TEST_CASE("Async queue capacity") {
+    SilkpreQueue* queue{silkpre_queue_create(4)};
+
+    const std::basic_string<uint8_t> in{random_bytes(1000)};
+    const SilkpreSubmission s{0, silkpre_contract_descriptor(1), in.data(), in.length(), SILKPRE_EVMC_BERLIN, 10'000};
+    const std::vector<SilkpreSubmission> submissions(10, s);
+    CHECK(silkpre_queue_submit(queue, submissions.data(), submissions.size()) == 4);
+    CHECK(silkpre_queue_submit(queue, submissions.data(), submissions.size()) == 0);
+    CHECK(silkpre_queue_in_flight(queue) == 4);
+
+    SilkpreCompletion c[2];
+    REQUIRE(silkpre_queue_wait(queue, c, 2, 2) == 2);
+    std::free(c[0].output.data);
+    std::free(c[1].output.data);
+    CHECK(silkpre_queue_in_flight(queue) == 2);
+    CHECK(silkpre_queue_submit(queue, submissions.data(), submissions.size()) == 2);
+
+    // Frees the outputs of the 4 calls left
+    silkpre_queue_destroy(queue);
+}
@@ -0,0 +1,88 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/batch.h>
+#include <silkpre/precompile.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+static SilkpreBatchJob make_job(uint8_t address, const std::basic_string<uint8_t>& input, uint64_t gas_limit) {
+    SilkpreBatchJob job{};
+    job.address[19] = address;
+    job.input = input.data();
+    job.input_len = input.length();
+    job.gas_limit = gas_limit;
+    return job;
+}
+
+TEST_CASE("Batch execution") {
+    const std::basic_string<uint8_t> tiny{random_bytes(3, 4)};
+    const std::basic_string<uint8_t> small{random_bytes(64, 1)};
+    const std::basic_string<uint8_t> large{random_bytes(4096, 2)};
+    const std::basic_string<uint8_t> expmod{expmod_input(256, random_bytes(256, 3), 256, /*odd_modulus=*/true)};
+    const std::basic_string<uint8_t> blake2{blake2_f_input(1'000)};
+
+    std::vector<SilkpreBatchJob> jobs;
+    for (int i{0}; i < 20; ++i) {
+        jobs.push_back(make_job(0x02, i % 2 ? small : large, 1'000'000));
+        jobs.push_back(make_job(0x03, small, 1'000'000));
+        jobs.push_back(make_job(0x04, large, 1'000'000));
+        jobs.push_back(make_job(0x09, blake2, 1'000'000));
+    }
+    jobs.push_back(make_job(0x05, expmod, 10'000'000));
+    jobs.push_back(make_job(0x05, expmod, 1));     // out of gas
+    jobs.push_back(make_job(0x0a, small, 1'000));  // beyond the last precompile
+    jobs.push_back(make_job(0x09, tiny, 1'000));   // invalid input
+
+    for (size_t threads : {1, 3, 0}) {
+        std::vector<SilkpreBatchJob> batch{jobs};
+        silkpre_execute_batch(batch.data(), batch.size(), SILKPRE_EVMC_BERLIN, threads);
+
+        for (size_t i{0}; i < jobs.size(); ++i) {
+            const SilkpreBatchJob& job{batch[i]};
+            const SilkpreContractDescriptor* contract{silkpre_lookup(job.address, SILKPRE_EVMC_BERLIN)};
+            if (!contract) {
+                CHECK(job.status == SILKPRE_NOT_A_PRECOMPILE);
+                CHECK(job.gas_used == 0);
+                CHECK(job.output.data == nullptr);
+                continue;
+            }
+            uint64_t gas_used;
+            SilkpreOutput expected;
+            const SilkpreStatus status{silkpre_execute(contract, job.input, job.input_len, SILKPRE_EVMC_BERLIN,
+                                                       job.gas_limit, &gas_used, &expected)};
+            CHECK(job.status == status);
+            CHECK(job.gas_used == gas_used);
+            CHECK((job.output.data != nullptr) == (expected.data != nullptr));
+            if (expected.data && job.output.data) {
+                CHECK(to_hex(job.output.data, job.output.size) == to_hex(expected.data, expected.size));
+            }
+            std::free(expected.data);
+            std::free(job.output.data);
+        }
+        CHECK(batch[jobs.size() - 3].status == SILKPRE_OUT_OF_GAS);
+        CHECK(batch[jobs.size() - 1].status == SILKPRE_INVALID_INPUT);
+    }
+
+    silkpre_execute_batch(nullptr, 0, SILKPRE_EVMC_BERLIN, 0);
+}
@@ -14,22 +14,424 @@
    limitations under the License.
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include <benchmark/benchmark.h>
+#include <secp256k1.h>
 
+#include <silkpre/arena.h>
+#include <silkpre/batch.h>
+#include <silkpre/ecdh.h>
+#include <silkpre/ecdsa.h>
+#include <silkpre/keccak.h>
 #include <silkpre/precompile.h>
+#include <silkpre/prefetch.h>
+#include <silkpre/secp256k1_context.h>
+#include <silkpre/sender_cache.h>
+#include <silkpre/sha256.h>
+
+#include "inputs.hpp"
+
+// Runs a contract on the same input, reporting gas/s next to the time per call
+// so that mispriced precompiles stand out.
+static void run_contract(benchmark::State& state, const SilkpreContract& contract,
+                         const std::basic_string<uint8_t>& in) {
+    const uint64_t gas{contract.gas(in.data(), in.length(), SILKPRE_EVMC_BERLIN)};
+    for (auto _ : state) {
+        SilkpreOutput out{contract.run(in.data(), in.length())};
+        benchmark::DoNotOptimize(out.data);
+        std::free(out.data);
+    }
+    state.counters["gas/s"] =
+        benchmark::Counter(static_cast<double>(gas), benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * in.length()));
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// Startup-to-first-call latency. Each iteration forks a process that inherits nothing warm
+// (these benchmarks are registered first, before anything sets up the library in the parent)
+// and times its first call of a contract, optionally after silkpre_init.
+static void cold_first_call(benchmark::State& state) {
+    const SilkpreContract& contract{state.range(0) < SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS
+                                        ? kSilkpreContracts[state.range(0)]
+                                        : kSilkpreP256VerifyContract};
+    const bool init{state.range(1) != 0};
+    std::basic_string<uint8_t> in;
+    switch (state.range(0)) {
+        case 0:
+            in = ecrec_input();
+            break;
+        case 5:
+            in = bn_add_input();
+            break;
+        case 6:
+            in = bn_mul_input();
+            break;
+        case 7:
+            in = snarkv_input(2);
+            break;
+        default:
+            in = p256verify_input();
+            break;
+    }
+
+    double init_seconds{0};
+    for (auto _ : state) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            state.SkipWithError("pipe");
+            break;
+        }
+        const pid_t pid{fork()};
+        if (pid == 0) {
+            using Clock = std::chrono::steady_clock;
+            double seconds[2]{0, 0};
+            const auto start{Clock::now()};
+            if (init) {
+                silkpre_init(SILKPRE_INIT_ALL);
+            }
+            const auto called{Clock::now()};
+            SilkpreOutput out{contract.run(in.data(), in.length())};
+            const auto done{Clock::now()};
+            std::free(out.data);
+            seconds[0] = std::chrono::duration<double>(called - start).count();
+            seconds[1] = std::chrono::duration<double>(done - called).count();
+            [[maybe_unused]] const auto written{write(fds[1], seconds, sizeof(seconds))};
+            _exit(0);
+        }
+        close(fds[1]);
+        double seconds[2]{0, 0};
+        const bool ok{pid > 0 && read(fds[0], seconds, sizeof(seconds)) == sizeof(seconds)};
+        close(fds[0]);
+        if (pid > 0) {
+            waitpid(pid, nullptr, 0);
+        }
+        if (!ok) {
+            state.SkipWithError("child failed");
+            break;
+        }
+        init_seconds += seconds[0];
+        state.SetIterationTime(seconds[1]);
+    }
+    state.counters["init_ms"] =
+        benchmark::Counter(init_seconds * 1e3 / static_cast<double>(std::max<int64_t>(state.iterations(), 1)));
+}
+
+BENCHMARK(cold_first_call)
+    ->ArgNames({"contract", "init"})
+    ->ArgsProduct({{0, 5, 6, 7, 9}, {0, 1}})
+    ->UseManualTime()
+    ->Iterations(20)
+    ->Unit(benchmark::kMicrosecond);
 
-#include "hex.hpp"
+#endif
+
+// Table sizes of the secp256k1 build, so that runs with different
+// SILKPRE_SECP256K1_ECMULT_WINDOW_SIZE / _GEN_PREC_BITS can be told apart.
+static void secp256k1_table_counters(benchmark::State& state) {
+    const auto set{[&](const char* name, double value) {
+        state.counters[name] = benchmark::Counter(value, benchmark::Counter::kAvgThreads);
+    }};
+    // 2^(w-2) points of 64 bytes for G, and as many for 2^128*G with the endomorphism
+    set("window", ECMULT_WINDOW_SIZE);
+    set("verify_table_kib", (size_t{1} << (ECMULT_WINDOW_SIZE - 2)) * 64 * 2 / 1024);
+    // 256/bits rows of 2^bits points; in .rodata with static tables, on the heap otherwise
+    set("gen_table_kib", (256 / ECMULT_GEN_PREC_BITS) * (size_t{1} << ECMULT_GEN_PREC_BITS) * 64 / 1024);
+#if defined(USE_ECMULT_STATIC_PRECOMPUTATION)
+    set("static_gen_table", 1);
+#else
+    set("static_gen_table", 0);
+#endif
+}
 
 static void ec_recovery(benchmark::State& state) {
-    std::basic_string<uint8_t> in{
-        from_hex("18c547e4f7b0f325ad1e56f57e26c745b09a3e503d86e00e5255ff7f715d3d1c0000000000000000000000000000"
-                 "00000000000000000000000000000000001c73b1693892219d736caba55bdb67216e485557ea6b6af75f37096c9a"
-                 "a6a5a75feeb940b1d03b21e36b0e47e79769f095fe2ab855bd91e3a38756b7d75a9c4549")};
+    run_contract(state, kSilkpreContracts[0], ecrec_input());
+    secp256k1_table_counters(state);
+}
+
+// The shared context is read-only, so throughput should scale with the number of threads
+BENCHMARK(ec_recovery)->ThreadRange(1, 8)->UseRealTime();
+
+// Second sighting of a transaction: the recovery is skipped
+static void sender_cache_hit(benchmark::State& state) {
+    const std::basic_string<uint8_t> in{ecrec_input()};
+    SilkpreSenderCache* cache{silkpre_sender_cache_create(1024, 0)};
+    uint8_t out[20];
+    silkpre_sender_cache_recover(cache, out, &in[0], &in[64], in[63] == 28);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(silkpre_sender_cache_recover(cache, out, &in[0], &in[64], in[63] == 28));
+    }
+    silkpre_sender_cache_destroy(cache);
+}
+
+BENCHMARK(sender_cache_hit);
+
+// Cost of building a context: the verification tables for VERIFY, the generator table for SIGN
+static void context_build(benchmark::State& state) {
+    const auto flags{static_cast<unsigned>(state.range(0))};
+    for (auto _ : state) {
+        secp256k1_context* context{secp256k1_context_create(flags)};
+        benchmark::DoNotOptimize(context);
+        secp256k1_context_destroy(context);
+    }
+    secp256k1_table_counters(state);
+}
+
+BENCHMARK(context_build)
+    ->Arg(SILKPRE_SECP256K1_CONTEXT_FLAGS)
+    ->Arg(SECP256K1_CONTEXT_SIGN)
+    ->Arg(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY)
+    ->Unit(benchmark::kMillisecond);
+
+// A burst of 256 handshakes against the node key: one call per peer (arg 0) vs a batch over 1..8 threads
+static void ecdh_burst(benchmark::State& state) {
+    constexpr size_t kPeers{256};
+    const std::basic_string<uint8_t> keys{random_bytes(32 * (kPeers + 1), 1)};
+    std::vector<secp256k1_pubkey> peers(kPeers);
+    for (size_t i{0}; i < kPeers; ++i) {
+        if (!secp256k1_ec_pubkey_create(silkpre_secp256k1_thread_context(), &peers[i], &keys[32 * (i + 1)])) {
+            state.SkipWithError("invalid key");
+            return;
+        }
+    }
+    const uint8_t* node_key{&keys[0]};
+    const auto threads{static_cast<size_t>(state.range(0))};
+    std::vector<uint8_t> shared(32 * kPeers);
+    for (auto _ : state) {
+        if (threads == 0) {
+            for (size_t i{0}; i < kPeers; ++i) {
+                silkpre_secp256k1_ecdh(nullptr, &shared[32 * i], &peers[i], node_key);
+            }
+        } else {
+            silkpre_secp256k1_ecdh_batch(nullptr, shared.data(), peers.data(), kPeers, node_key, threads);
+        }
+        benchmark::DoNotOptimize(shared.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kPeers));
+}
+
+BENCHMARK(ecdh_burst)->Arg(0)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 0B..1MiB
+static void input_sizes(benchmark::internal::Benchmark* b) {
+    b->Arg(0)->RangeMultiplier(8)->Range(1, 1 << 20);
+}
+
+static void sha256(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[1], random_bytes(static_cast<size_t>(state.range(0))));
+}
+
+BENCHMARK(sha256)->Apply(input_sizes);
+
+static void sha256_merkleize(benchmark::State& state) {
+    const size_t n{static_cast<size_t>(state.range(0))};
+    const std::basic_string<uint8_t> leaves{random_bytes(32 * n)};
+    uint8_t root[32];
+    for (auto _ : state) {
+        silkpre_sha256_merkleize(root, leaves.data(), n, /*use_cpu_extensions=*/true);
+        benchmark::DoNotOptimize(root);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (n - 1)));
+}
+
+BENCHMARK(sha256_merkleize)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+static void keccak256(benchmark::State& state) {
+    const std::basic_string<uint8_t> in{random_bytes(static_cast<size_t>(state.range(0)))};
+    uint8_t hash[32];
+    for (auto _ : state) {
+        silkpre_keccak256(hash, in.data(), in.length());
+        benchmark::DoNotOptimize(hash);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * in.length()));
+}
+
+BENCHMARK(keccak256)->Apply(input_sizes);
+
+static void ripemd160(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[2], random_bytes(static_cast<size_t>(state.range(0))));
+}
+
+BENCHMARK(ripemd160)->Apply(input_sizes);
+
+static void identity(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[3], random_bytes(static_cast<size_t>(state.range(0))));
+}
+
+BENCHMARK(identity)->Apply(input_sizes);
+
+// Large identity outputs: owned copy (arg 0) vs borrowed view of the input (arg 1)
+static void identity_view(benchmark::State& state) {
+    const std::basic_string<uint8_t> in{random_bytes(static_cast<size_t>(state.range(1)))};
+    const SilkpreContractDescriptor* id{silkpre_contract_descriptor(3)};
+    uint64_t gas_used{0};
+    for (auto _ : state) {
+        if (state.range(0)) {
+            SilkpreView view{};
+            silkpre_execute_view(id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX, &gas_used, &view);
+            benchmark::DoNotOptimize(view.data);
+        } else {
+            SilkpreOutput out{};
+            silkpre_execute(id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX, &gas_used, &out);
+            benchmark::DoNotOptimize(out.data);
+            std::free(out.data);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * in.length()));
+}
+
+BENCHMARK(identity_view)->ArgsProduct({{0, 1}, {1 << 16, 1 << 22, 1 << 24}});
+
+// A block's worth of small outputs held until the end of the block: malloc'ed and freed one by one (arg 0)
+// vs allocated from an arena that is reset per block (arg 1)
+static void block_outputs(benchmark::State& state) {
+    constexpr size_t kCallsPerBlock{256};
+    const std::basic_string<uint8_t> in{random_bytes(32)};
+    SilkpreArena* arena{state.range(0) ? silkpre_arena_create(0) : nullptr};
+    std::vector<uint8_t*> outputs(kCallsPerBlock);
+    for (auto _ : state) {
+        for (size_t i{0}; i < kCallsPerBlock; ++i) {
+            const SilkpreOutput out{arena ? silkpre_arena_run(arena, silkpre_id_run, in.data(), in.length())
+                                          : silkpre_id_run(in.data(), in.length())};
+            outputs[i] = out.data;
+        }
+        benchmark::DoNotOptimize(outputs.data());
+        if (arena) {
+            silkpre_arena_reset(arena);
+        } else {
+            for (uint8_t* out : outputs) {
+                std::free(out);
+            }
+        }
+    }
+    if (arena) {
+        silkpre_arena_destroy(arena);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kCallsPerBlock));
+}
+
+BENCHMARK(block_outputs)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// Exponents of the EIP-2565 (nagydani) vectors plus a full-width worst case
+static const std::basic_string<uint8_t> kExponents[]{
+    {0x02},
+    {0x03},
+    {0x01, 0x00, 0x01},
+    std::basic_string<uint8_t>(32, 0xff),
+};
+
+static void expmod(benchmark::State& state) {
+    const size_t len{static_cast<size_t>(state.range(0))};
+    const std::basic_string<uint8_t>& exp{kExponents[state.range(1)]};
+    run_contract(state, kSilkpreContracts[4], expmod_input(len, exp, len, /*odd_modulus=*/state.range(2) != 0));
+}
+
+BENCHMARK(expmod)
+    ->ArgNames({"len", "exp", "odd"})
+    ->ArgsProduct({{64, 128, 256, 512, 1024}, {0, 1, 2, 3}, {1, 0}});
+
+// Block import latency of a modexp call as is (arg 0) vs pre-executed from a hint (arg 1)
+static void prefetched_expmod(benchmark::State& state) {
+    uint8_t address[20]{};
+    address[19] = 0x05;
+    const std::basic_string<uint8_t> in{expmod_input(256, kExponents[3], 256, /*odd_modulus=*/true)};
+    const SilkpreContractDescriptor* contract{silkpre_lookup(address, SILKPRE_EVMC_BERLIN)};
+    if (state.range(0)) {
+        silkpre_prefetch_start(1 << 20, 16, 1);
+        silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_BERLIN);
+        for (SilkprePrefetchStats stats{}; stats.executed == 0; silkpre_prefetch_stats(&stats)) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto _ : state) {
+        uint64_t gas_used;
+        SilkpreOutput out;
+        silkpre_execute(contract, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX, &gas_used, &out);
+        benchmark::DoNotOptimize(out.data);
+        std::free(out.data);
+    }
+    if (state.range(0)) {
+        silkpre_prefetch_stop();
+    }
+}
+
+BENCHMARK(prefetched_expmod)->Arg(0)->Arg(1);
+
+static void bn_add(benchmark::State& state) { run_contract(state, kSilkpreContracts[5], bn_add_input()); }
+
+BENCHMARK(bn_add);
+
+// Multiplies the generator, which goes through its comb table
+static void bn_mul(benchmark::State& state) { run_contract(state, kSilkpreContracts[6], bn_mul_input()); }
+
+BENCHMARK(bn_mul);
+
+static void bn_mul_variable_base(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[6], bn_mul_variable_base_input());
+}
+
+BENCHMARK(bn_mul_variable_base);
+
+static void snarkv(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[7], snarkv_input(static_cast<size_t>(state.range(0))));
+}
+
+BENCHMARK(snarkv)->DenseRange(1, 10)->Unit(benchmark::kMillisecond);
+
+static void blake2_f(benchmark::State& state) {
+    run_contract(state, kSilkpreContracts[8], blake2_f_input(static_cast<uint32_t>(state.range(0))));
+}
+
+BENCHMARK(blake2_f)->RangeMultiplier(4)->Range(1, 1 << 20);
+
+static void p256verify(benchmark::State& state) { run_contract(state, kSilkpreP256VerifyContract, p256verify_input()); }
+
+BENCHMARK(p256verify);
+
+// A block's mix of calls: many cheap ones and a few expensive ones, over 1..8 threads
+static void execute_batch(benchmark::State& state) {
+    const std::basic_string<uint8_t> hashed{random_bytes(1024)};
+    const std::basic_string<uint8_t> ecrec{ecrec_input()};
+    const std::basic_string<uint8_t> expmod{expmod_input(512, random_bytes(512, 2), 512, /*odd_modulus=*/true)};
+    const std::basic_string<uint8_t> pairing{snarkv_input(4)};
+
+    std::vector<SilkpreBatchJob> jobs;
+    const auto add{[&](uint8_t address, const std::basic_string<uint8_t>& input, size_t count) {
+        for (size_t i{0}; i < count; ++i) {
+            SilkpreBatchJob job{};
+            job.address[19] = address;
+            job.input = input.data();
+            job.input_len = input.length();
+            job.gas_limit = 30'000'000;
+            jobs.push_back(job);
+        }
+    }};
+    add(0x02, hashed, 200);
+    add(0x01, ecrec, 50);
+    add(0x05, expmod, 4);
+    add(0x08, pairing, 2);
+
+    const auto threads{static_cast<size_t>(state.range(0))};
     for (auto _ : state) {
-        silkpre_ecrec_run(in.data(), in.length());
+        silkpre_execute_batch(jobs.data(), jobs.size(), SILKPRE_EVMC_BERLIN, threads);
+        for (SilkpreBatchJob& job : jobs) {
+            std::free(job.output.data);
+        }
     }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * jobs.size()));
 }
 
-BENCHMARK(ec_recovery);
+BENCHMARK(execute_batch)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,100 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/budget.h>
+#include <silkpre/precompile.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+// EIP-152 test vector 8: 2^32 - 1 rounds
+static const std::basic_string<uint8_t> kBlake2MaxRounds{
+    from_hex("ffffffff48c9bdf267e6096a3ba7ca8485ae67bb2bf894fe72f36e3cf1361d5f3af54fa5d182e6ad7f520e511f6c3e"
+             "2b8c68059b6bbd41fbabd9831f79217e1319cde05b61626300000000000000000000000000000000000000000000"
+             "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+             "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+             "00000000000000000000000300000000000000000000000000000001")};
+
+TEST_CASE("Budget exceeded") {
+    constexpr uint64_t kBudgetNs{10'000'000};
+    const SilkpreContractDescriptor* blake2f{silkpre_contract_descriptor(8)};
+    const SilkpreContractDescriptor* expmod{silkpre_contract_descriptor(4)};
+    // An even 8192-bit modulus and a full 8192-bit exponent
+    const std::basic_string<uint8_t> slow_expmod{
+        expmod_input(1024, std::basic_string<uint8_t>(1024, 0xff), 1024, /*odd_modulus=*/false)};
+
+    for (const auto& [contract, in] : {std::pair{blake2f, kBlake2MaxRounds}, std::pair{expmod, slow_expmod}}) {
+        uint64_t gas_used{0};
+        SilkpreOutput out{};
+        const auto start{std::chrono::steady_clock::now()};
+        CHECK(silkpre_execute_budget(contract, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX, kBudgetNs,
+                                     &gas_used, &out) == SILKPRE_BUDGET_EXCEEDED);
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{1});
+        CHECK(gas_used == UINT64_MAX);
+        CHECK(!out.data);
+    }
+}
+
+TEST_CASE("Budget not exceeded") {
+    const SilkpreContractDescriptor* blake2f{silkpre_contract_descriptor(8)};
+    const SilkpreContractDescriptor* expmod{silkpre_contract_descriptor(4)};
+
+    std::basic_string<uint8_t> in{kBlake2MaxRounds};
+    in[0] = in[1] = in[2] = 0;
+    in[3] = 12;
+    uint64_t gas_used{0};
+    SilkpreOutput out{};
+    CHECK(silkpre_execute_budget(blake2f, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 100, UINT64_MAX, &gas_used,
+                                 &out) == SILKPRE_SUCCESS);
+    CHECK(gas_used == 12);
+    REQUIRE(out.data);
+    CHECK(to_hex(out.data, out.size) ==
+          "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+          "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923");
+    std::free(out.data);
+
+    // Out of gas is still decided up front
+    CHECK(silkpre_execute_budget(blake2f, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 11, 0, &gas_used, &out) ==
+          SILKPRE_OUT_OF_GAS);
+
+    // The interruptible modexp agrees with mpz_powm; the 300-byte exponent is long enough to be polled
+    // with the 200-byte moduli
+    for (const size_t len : {1, 31, 64, 200}) {
+        for (const bool odd : {true, false}) {
+            for (const auto& exp : {std::basic_string<uint8_t>{}, std::basic_string<uint8_t>{0x01},
+                                    std::basic_string<uint8_t>{0x01, 0x00, 0x01}, random_bytes(40, len),
+                                    random_bytes(300, len)}) {
+                in = expmod_input(len + 3, exp, len, odd);
+                SilkpreOutput expected{};
+                REQUIRE(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX, &gas_used,
+                                        &expected) == SILKPRE_SUCCESS);
+                REQUIRE(silkpre_execute_budget(expmod, in.data(), in.length(), SILKPRE_EVMC_BERLIN, UINT64_MAX,
+                                               UINT64_MAX, &gas_used, &out) == SILKPRE_SUCCESS);
+                CHECK(to_hex(out.data, out.size) == to_hex(expected.data, expected.size));
+                std::free(expected.data);
+                std::free(out.data);
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdlib>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/cache.h>
+#include <silkpre/lru_cache.hpp>
+
+#include "hex.hpp"
+
+TEST_CASE("LRU eviction") {
+    silkpre::ShardedLruCache<int, int> lru{/*capacity=*/2, /*num_shards=*/1};
+    lru.put(1, 10);
+    lru.put(2, 20);
+    CHECK(lru.get(1) == 10);  // 2 becomes the least recently used
+    lru.put(3, 30);
+    CHECK(!lru.get(2));
+    CHECK(lru.get(1) == 10);
+    CHECK(lru.get(3) == 30);
+
+    lru.put(4, 40, /*weight=*/3);  // heavier than the whole shard
+    CHECK(!lru.get(4));
+
+    const silkpre::LruCacheStats stats{lru.stats()};
+    CHECK(stats.hits == 3);
+    CHECK(stats.misses == 2);
+    CHECK(stats.insertions == 3);
+    CHECK(stats.evictions == 1);
+}
+
+TEST_CASE("Cached execute") {
+    SilkpreCache* cache{silkpre_cache_create(1 << 20, 0)};
+    REQUIRE(cache);
+
+    const SilkpreContractDescriptor* expmod{silkpre_contract_descriptor(4)};
+    REQUIRE(expmod);
+    const std::basic_string<uint8_t> in{
+        from_hex("0000000000000000000000000000000000000000000000000000000000000001"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "03"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f")};
+
+    uint64_t gas_used{0};
+    SilkpreOutput out{};
+    for (int i{0}; i < 2; ++i) {
+        CHECK(silkpre_cache_execute(cache, expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 20'000, &gas_used,
+                                    &out) == SILKPRE_SUCCESS);
+        CHECK(gas_used == 13056);
+        REQUIRE(out.data);
+        CHECK(to_hex(out.data, out.size) == "0000000000000000000000000000000000000000000000000000000000000001");
+        std::free(out.data);
+    }
+
+    // Out of gas is decided before the lookup
+    CHECK(silkpre_cache_execute(cache, expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 13055, &gas_used,
+                                &out) == SILKPRE_OUT_OF_GAS);
+    CHECK(gas_used == 13055);
+    CHECK(!out.data);
+
+    // Invalid inputs are cached too
+    const SilkpreContractDescriptor* p256{silkpre_contract_descriptor(9)};
+    REQUIRE(p256);
+    const std::basic_string<uint8_t> bad_sig(160, 0);
+    for (int i{0}; i < 2; ++i) {
+        CHECK(silkpre_cache_execute(cache, p256, bad_sig.data(), bad_sig.length(), SILKPRE_EVMC_BERLIN, 10'000,
+                                    &gas_used, &out) == SILKPRE_SUCCESS);
+        CHECK(gas_used == 3450);
+        REQUIRE(out.data);
+        CHECK(out.size == 0);
+        std::free(out.data);
+    }
+
+    // Cheap contracts bypass the cache by default
+    const SilkpreContractDescriptor* id{silkpre_contract_descriptor(3)};
+    REQUIRE(id);
+    CHECK(silkpre_cache_execute(cache, id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 1'000, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    CHECK(out.size == in.length());
+    std::free(out.data);
+
+    SilkpreCacheStats stats{};
+    silkpre_cache_stats(cache, &stats);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 2);
+    CHECK(stats.insertions == 2);
+    CHECK(stats.evictions == 0);
+
+    // ... unless admitted explicitly
+    silkpre_cache_set_admission_threshold(cache, id->index, 0);
+    CHECK(silkpre_cache_execute(cache, id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 1'000, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    std::free(out.data);
+    silkpre_cache_stats(cache, &stats);
+    CHECK(stats.misses == 3);
+
+    silkpre_cache_destroy(cache);
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstring>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/blake2b.h>
+#include <silkpre/cpu.h>
+#include <silkpre/keccak.h>
+#include <silkpre/p256.h>
+#include <silkpre/rmd160.h>
+#include <silkpre/sha256.h>
+
+#include "hex.hpp"
+#include "inputs.hpp"
+
+TEST_CASE("CPU tiers") {
+    const uint32_t detected{silkpre_cpu_detected_features()};
+    CHECK(silkpre_cpu_set_tier(SILKPRE_CPU_TIER_GENERIC) == 0);
+    for (int k{SILKPRE_KERNEL_SHA256}; k <= SILKPRE_KERNEL_KECCAK; ++k) {
+        CHECK(std::strcmp(silkpre_cpu_kernel(static_cast<SilkpreKernel>(k)), "generic") == 0);
+    }
+    CHECK(silkpre_cpu_restrict(SILKPRE_CPU_BMI2) == (detected & SILKPRE_CPU_BMI2));
+    CHECK(silkpre_cpu_set_tier(SILKPRE_CPU_TIER_NATIVE) == detected);
+    CHECK(silkpre_cpu_features() == detected);
+}
+
+TEST_CASE("Kernels agree across tiers") {
+    const std::basic_string<uint8_t> data{random_bytes(1000)};
+    const std::basic_string<uint8_t> p256{p256verify_input()};
+
+    std::string expected;
+    for (int tier{SILKPRE_CPU_TIER_GENERIC}; tier <= SILKPRE_CPU_TIER_NATIVE; ++tier) {
+        silkpre_cpu_set_tier(static_cast<SilkpreCpuTier>(tier));
+
+        std::string digests;
+        for (size_t len : {0, 55, 64, 119, 1000}) {
+            uint8_t hash[32];
+            silkpre_sha256(hash, data.data(), len, /*use_cpu_extensions=*/true);
+            digests += to_hex(hash, 32);
+            silkpre_rmd160(hash, data.data(), len);
+            digests += to_hex(hash, 20);
+            silkpre_keccak256(hash, data.data(), len);
+            digests += to_hex(hash, 32);
+        }
+        uint8_t root[32];
+        REQUIRE(silkpre_sha256_merkleize(root, data.data(), 1000 / 32, /*use_cpu_extensions=*/true));
+        digests += to_hex(root, 32);
+        for (size_t rounds : {0, 1, 12, 25}) {
+            SilkpreBlake2bState state{};
+            std::memcpy(&state, data.data(), sizeof(state));
+            silkpre_blake2b_compress(&state, data.data() + 100, rounds);
+            digests += to_hex(reinterpret_cast<const uint8_t*>(state.h), sizeof(state.h));
+        }
+
+        const uint8_t* p{p256.data()};
+        CHECK(silkpre_p256_verify(p, p + 32, p + 64, p + 96, p + 128));
+
+        if (tier == SILKPRE_CPU_TIER_GENERIC) {
+            expected = digests;
+        } else {
+            CHECK(digests == expected);
+        }
+    }
+    silkpre_cpu_set_tier(SILKPRE_CPU_TIER_NATIVE);
+}
@@ -0,0 +1,189 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/ecdh.h>
+#include <silkpre/ecdsa.h>
+#include <silkpre/secp256k1_context.h>
+#include <silkpre/sender_cache.h>
+
+#include "hex.hpp"
+
+static const std::basic_string<uint8_t> kMessage{
+    from_hex("18c547e4f7b0f325ad1e56f57e26c745b09a3e503d86e00e5255ff7f715d3d1c")};
+static const std::basic_string<uint8_t> kSignature{
+    from_hex("73b1693892219d736caba55bdb67216e485557ea6b6af75f37096c9aa6a5a75f"
+             "eeb940b1d03b21e36b0e47e79769f095fe2ab855bd91e3a38756b7d75a9c4549")};
+static const char* kAddress{"a94f5374fce5edbc8e2a8697c15331677e6ebf0b"};
+
+TEST_CASE("Recover address with library context") {
+    uint8_t out[20];
+    REQUIRE(silkpre_recover_address(out, kMessage.data(), kSignature.data(), true, nullptr));
+    CHECK(to_hex(out, 20) == kAddress);
+
+    REQUIRE(silkpre_recover_address(out, kMessage.data(), kSignature.data(), true, silkpre_secp256k1_context()));
+    CHECK(to_hex(out, 20) == kAddress);
+
+    secp256k1_context* own{secp256k1_context_create(SILKPRE_SECP256K1_CONTEXT_FLAGS)};
+    REQUIRE(silkpre_recover_address(out, kMessage.data(), kSignature.data(), true, own));
+    CHECK(to_hex(out, 20) == kAddress);
+    secp256k1_context_destroy(own);
+
+    // Wrong parity recovers a different key
+    REQUIRE(silkpre_recover_address(out, kMessage.data(), kSignature.data(), false, nullptr));
+    CHECK(to_hex(out, 20) != kAddress);
+}
+
+TEST_CASE("Recover public key") {
+    uint8_t public_key[65];
+    REQUIRE(silkpre_recover_public_key(public_key, kMessage.data(), kSignature.data(), true, nullptr));
+    CHECK(to_hex(public_key, 65) ==
+          "043a514176466fa815ed481ffad09110a2d344f6c9b78c1d14afc351c3a51be33d"
+          "8072e77939dc03ba44790779b7a1025baf3003f6732430e20cd9b76d953391b3");
+
+    uint8_t out[20];
+    REQUIRE(silkpre_public_key_to_address(out, public_key));
+    CHECK(to_hex(out, 20) == kAddress);
+
+    public_key[0] = 2;  // compressed
+    CHECK(!silkpre_public_key_to_address(out, public_key));
+}
+
+TEST_CASE("Sender cache") {
+    SilkpreSenderCache* cache{silkpre_sender_cache_create(/*capacity=*/2, /*num_shards=*/1)};
+    SilkpreCacheStats stats;
+
+    for (int i{0}; i < 2; ++i) {
+        uint8_t out[20]{};
+        REQUIRE(silkpre_sender_cache_recover(cache, out, kMessage.data(), kSignature.data(), true));
+        CHECK(to_hex(out, 20) == kAddress);
+    }
+    silkpre_sender_cache_stats(cache, &stats);
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == 1);
+
+    // Failures are cached too
+    std::basic_string<uint8_t> bad_signature{kSignature};
+    bad_signature.replace(0, 32, 32, 0);  // r = 0
+    for (int i{0}; i < 2; ++i) {
+        uint8_t out[20];
+        CHECK(!silkpre_sender_cache_recover(cache, out, kMessage.data(), bad_signature.data(), true));
+    }
+    silkpre_sender_cache_stats(cache, &stats);
+    CHECK(stats.misses == 2);
+    CHECK(stats.hits == 2);
+
+    // The parity is part of the key
+    uint8_t out[20];
+    REQUIRE(silkpre_sender_cache_recover(cache, out, kMessage.data(), kSignature.data(), false));
+    CHECK(to_hex(out, 20) != kAddress);
+    silkpre_sender_cache_stats(cache, &stats);
+    CHECK(stats.misses == 3);
+    CHECK(stats.evictions == 1);
+
+    silkpre_sender_cache_destroy(cache);
+}
+
+TEST_CASE("Thread contexts") {
+    secp256k1_context* main_context{silkpre_secp256k1_thread_context()};
+    REQUIRE(main_context);
+    CHECK(silkpre_secp256k1_thread_context() == main_context);
+
+    constexpr size_t kThreads{4};
+    std::array<secp256k1_context*, kThreads> contexts{};
+    std::array<bool, kThreads> recovered{};
+    std::vector<std::thread> threads;
+    for (size_t i{0}; i < kThreads; ++i) {
+        threads.emplace_back([&, i] {
+            contexts[i] = silkpre_secp256k1_thread_context();
+            bool ok{true};
+            for (int n{0}; n < 50; ++n) {
+                uint8_t out[20];
+                ok &= silkpre_recover_address(out, kMessage.data(), kSignature.data(), true, nullptr) &&
+                      to_hex(out, 20) == kAddress;
+            }
+            recovered[i] = ok;
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (size_t i{0}; i < kThreads; ++i) {
+        CHECK(recovered[i]);
+        CHECK(contexts[i]);
+        CHECK(contexts[i] != main_context);
+    }
+}
+
+TEST_CASE("ECDH with library context") {
+    const std::basic_string<uint8_t> private_key{
+        from_hex("0000000000000000000000000000000000000000000000000000000000000001")};
+    secp256k1_pubkey public_key;
+    const std::basic_string<uint8_t> serialized{
+        from_hex("0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798")};
+    REQUIRE(secp256k1_ec_pubkey_parse(silkpre_secp256k1_context(), &public_key, serialized.data(),
+                                      serialized.length()));
+    uint8_t x[32];
+    REQUIRE(silkpre_secp256k1_ecdh(nullptr, x, &public_key, private_key.data()));
+    CHECK(to_hex(x, 32) == "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+}
+
+TEST_CASE("Batch ECDH") {
+    constexpr size_t kKeys{37};
+    std::vector<uint8_t> private_keys(32 * kKeys);
+    std::vector<secp256k1_pubkey> public_keys(kKeys);
+    for (size_t i{0}; i < kKeys; ++i) {
+        private_keys[32 * i + 31] = static_cast<uint8_t>(i + 1);
+        private_keys[32 * i] = static_cast<uint8_t>(i * 7);
+        REQUIRE(secp256k1_ec_pubkey_create(silkpre_secp256k1_thread_context(), &public_keys[i],
+                                           &private_keys[32 * i]));
+    }
+    const uint8_t* local_key{&private_keys[32 * 5]};
+
+    std::vector<uint8_t> expected(32 * kKeys);
+    for (size_t i{0}; i < kKeys; ++i) {
+        REQUIRE(silkpre_secp256k1_ecdh(nullptr, &expected[32 * i], &public_keys[i], local_key));
+    }
+    for (size_t threads : {1, 3, 0}) {
+        std::vector<uint8_t> outputs(32 * kKeys);
+        REQUIRE(silkpre_secp256k1_ecdh_batch(nullptr, outputs.data(), public_keys.data(), kKeys, local_key, threads));
+        CHECK(outputs == expected);
+    }
+
+    const uint8_t zero_key[32]{};
+    std::vector<uint8_t> outputs(32 * kKeys);
+    CHECK(!silkpre_secp256k1_ecdh_batch(nullptr, outputs.data(), public_keys.data(), kKeys, zero_key, 1));
+
+    // ECDH is symmetric: a*B == b*A
+    std::vector<secp256k1_pubkey> local_public(kKeys, public_keys[5]);
+    bool results[kKeys];
+    std::memset(&private_keys[32 * 11], 0, 32);  // invalid
+    CHECK(silkpre_secp256k1_ecdh_pairs(nullptr, outputs.data(), results, local_public.data(), private_keys.data(),
+                                       kKeys, 4) == kKeys - 1);
+    for (size_t i{0}; i < kKeys; ++i) {
+        CHECK(results[i] == (i != 11));
+        if (i != 11) {
+            CHECK(std::memcmp(&outputs[32 * i], &expected[32 * i], 32) == 0);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Compares accelerated code paths against reference ones on the same input.
+// The first input byte selects the check.
+
+#include <gmp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <silkpre/p256.h>
+#include <silkpre/precompile.h>
+#include <silkpre/sha256.h>
+
+// CPU extensions (SHA-NI, ARMv8 crypto) against the generic C kernel
+static void sha256(const uint8_t* data, size_t size) {
+    uint8_t accelerated[32];
+    uint8_t generic[32];
+    silkpre_sha256(accelerated, data, size, /*use_cpu_extensions=*/true);
+    silkpre_sha256(generic, data, size, /*use_cpu_extensions=*/false);
+    if (std::memcmp(accelerated, generic, 32) != 0) {
+        std::abort();
+    }
+}
+
+// The precompile, both directly and through silkpre_execute, against plain mpz_powm.
+// Input: base_len | exp_len | mod_len (one byte each) | base | exp | mod, truncated or zero-padded.
+static void expmod(const uint8_t* data, size_t size) {
+    if (size < 3) {
+        return;
+    }
+    const size_t lens[3]{data[0], data[1], data[2]};
+    std::basic_string<uint8_t> operands(data + 3, size - 3);
+    operands.resize(lens[0] + lens[1] + lens[2]);
+
+    std::basic_string<uint8_t> in;
+    for (size_t len : lens) {
+        uint8_t word[32]{};
+        word[31] = static_cast<uint8_t>(len);
+        in.append(word, 32);
+    }
+    in += operands;
+
+    mpz_t x[3];
+    size_t offset{0};
+    for (size_t i{0}; i < 3; ++i) {
+        mpz_init(x[i]);
+        mpz_import(x[i], lens[i], 1, 1, 0, 0, operands.data() + offset);
+        offset += lens[i];
+    }
+    std::basic_string<uint8_t> expected(lens[2], 0);
+    if (mpz_sgn(x[2]) != 0) {
+        mpz_powm(x[0], x[0], x[1], x[2]);
+        size_t count{0};
+        mpz_export(expected.data(), &count, -1, 1, 0, 0, x[0]);
+        std::reverse(expected.begin(), expected.end());
+    }
+    for (mpz_t& v : x) {
+        mpz_clear(v);
+    }
+
+    SilkpreOutput out{silkpre_expmod_run(in.data(), in.size())};
+    if (!out.data || out.size != expected.size() || std::memcmp(out.data, expected.data(), out.size) != 0) {
+        std::abort();
+    }
+    std::free(out.data);
+
+    const SilkpreContractDescriptor* contract{silkpre_contract_descriptor(4)};
+    uint64_t gas_used{0};
+    if (silkpre_execute(contract, in.data(), in.size(), SILKPRE_EVMC_BERLIN, UINT64_MAX, &gas_used, &out) !=
+            SILKPRE_SUCCESS ||
+        out.size != expected.size() || std::memcmp(out.data, expected.data(), out.size) != 0) {
+        std::abort();
+    }
+    std::free(out.data);
+}
+
+// Batch verification (shared inversion) against one-by-one verification
+static void p256_batch(const uint8_t* data, size_t size) {
+    const size_t n{std::min<size_t>(size / SILKPRE_P256_VERIFY_INPUT_SIZE, 16)};
+    bool results[16];
+    silkpre_p256_verify_batch(results, data, n);
+    for (size_t i{0}; i < n; ++i) {
+        const uint8_t* p{data + i * SILKPRE_P256_VERIFY_INPUT_SIZE};
+        if (results[i] != silkpre_p256_verify(p, p + 32, p + 64, p + 96, p + 128)) {
+            std::abort();
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    switch (data[0] % 3) {
+        case 0:
+            sha256(data + 1, size - 1);
+            break;
+        case 1:
+            expmod(data + 1, size - 1);
+            break;
+        case 2:
+            p256_batch(data + 1, size - 1);
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Fuzzes the gas and run functions of a contract and checks silkpre_execute against them.
+// Built once per contract with SILKPRE_FUZZ_CONTRACT set to its descriptor index;
+// without it the first input byte picks the contract.
+
+#include <cstdlib>
+#include <cstring>
+
+#include <silkpre/precompile.h>
+
+static constexpr uint64_t kMaxGas{1'000'000};
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+#if defined(SILKPRE_FUZZ_CONTRACT)
+    const SilkpreContractDescriptor* contract{silkpre_contract_descriptor(SILKPRE_FUZZ_CONTRACT)};
+#else
+    if (size == 0) {
+        return 0;
+    }
+    const SilkpreContractDescriptor* contract{silkpre_contract_descriptor(data[0] % SILKPRE_NUMBER_OF_CONTRACTS)};
+    ++data;
+    --size;
+#endif
+
+    for (int rev{SILKPRE_EVMC_FRONTIER}; rev <= SILKPRE_EVMC_BERLIN; ++rev) {
+        contract->gas(data, size, rev);
+    }
+
+    // Like the EVM, don't run what nobody could pay for (e.g. huge modexp lengths or blake2f rounds)
+    const uint64_t gas{contract->gas(data, size, SILKPRE_EVMC_BERLIN)};
+    if (gas > kMaxGas) {
+        return 0;
+    }
+
+    SilkpreOutput out{contract->run(data, size)};
+    if (out.data && contract->output_size && out.size && out.size != contract->output_size) {
+        std::abort();
+    }
+
+    // Same outcome when run through the parse-once path
+    uint64_t gas_used{0};
+    SilkpreOutput exec_out{nullptr, 0};
+    const SilkpreStatus status{
+        silkpre_execute(contract, data, size, SILKPRE_EVMC_BERLIN, kMaxGas, &gas_used, &exec_out)};
+    if ((status == SILKPRE_SUCCESS) != (out.data != nullptr)) {
+        std::abort();
+    }
+    if (status == SILKPRE_SUCCESS &&
+        (gas_used != gas || exec_out.size != out.size || std::memcmp(exec_out.data, out.data, out.size) != 0)) {
+        std::abort();
+    }
+    std::free(exec_out.data);
+    std::free(out.data);
+    return 0;
+}
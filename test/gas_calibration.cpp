@@ -0,0 +1,233 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Measures the run time of every precompile over a sweep of input classes and compares it
+// against the gas charged, reporting Mgas/s per class and a per-contract linear fit
+// time ≈ a + b·gas. Classes whose throughput is far below the median are flagged.
+//
+// Usage: gas_calibration [--json] [--min-time-ms=N] [--threshold=X]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <silkpre/precompile.h>
+
+#include "inputs.hpp"
+
+struct InputClass {
+    const char* contract;
+    std::string label;
+    const SilkpreContract* impl;
+    std::basic_string<uint8_t> input;
+};
+
+struct Measurement {
+    const InputClass* cls;
+    uint64_t gas;
+    double ns;
+    double mgas_per_s;
+    bool outlier;
+};
+
+static std::vector<InputClass> input_classes() {
+    std::vector<InputClass> classes;
+    classes.push_back({"ecrecover", "valid", &kSilkpreContracts[0], ecrec_input()});
+
+    const char* hashes[]{"sha256", "ripemd160", "identity"};
+    for (size_t i{0}; i < 3; ++i) {
+        for (size_t len : {0, 32, 256, 4096, 65536, 1 << 20}) {
+            classes.push_back({hashes[i], "len=" + std::to_string(len), &kSilkpreContracts[i + 1], random_bytes(len)});
+        }
+    }
+
+    const std::pair<const char*, std::basic_string<uint8_t>> exponents[]{
+        {"3", {0x03}},
+        {"65537", {0x01, 0x00, 0x01}},
+        {"max256", std::basic_string<uint8_t>(32, 0xff)},
+    };
+    for (size_t len : {32, 64, 128, 256, 512}) {
+        for (const auto& [name, exp] : exponents) {
+            for (bool odd : {true, false}) {
+                std::string label{"len=" + std::to_string(len) + " exp=" + name + (odd ? " odd" : " even")};
+                classes.push_back({"modexp", label, &kSilkpreContracts[4], expmod_input(len, exp, len, odd)});
+            }
+        }
+    }
+
+    classes.push_back({"bn256_add", "G+G", &kSilkpreContracts[5], bn_add_input()});
+    classes.push_back({"bn256_mul", "G, full scalar", &kSilkpreContracts[6], bn_mul_input()});
+    classes.push_back({"bn256_mul", "2G, full scalar", &kSilkpreContracts[6], bn_mul_variable_base_input()});
+    for (size_t k{1}; k <= 6; ++k) {
+        classes.push_back({"bn256_pairing", "k=" + std::to_string(k), &kSilkpreContracts[7], snarkv_input(k)});
+    }
+    for (uint32_t rounds : {1u, 12u, 1024u, 65536u, 1u << 20}) {
+        classes.push_back(
+            {"blake2f", "rounds=" + std::to_string(rounds), &kSilkpreContracts[8], blake2_f_input(rounds)});
+    }
+    classes.push_back({"p256verify", "valid", &kSilkpreP256VerifyContract, p256verify_input()});
+    return classes;
+}
+
+// Best of several batches, each running for about min_time / 5
+static double ns_per_call(const InputClass& cls, double min_time_ns) {
+    using Clock = std::chrono::steady_clock;
+    const auto run_once{[&] {
+        SilkpreOutput out{cls.impl->run(cls.input.data(), cls.input.size())};
+        std::free(out.data);
+    }};
+
+    // Calibrate the batch size
+    size_t batch{1};
+    for (;;) {
+        const auto start{Clock::now()};
+        for (size_t i{0}; i < batch; ++i) {
+            run_once();
+        }
+        const double ns{std::chrono::duration<double, std::nano>(Clock::now() - start).count()};
+        if (ns >= min_time_ns / 5 || batch >= (size_t{1} << 30)) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    double best{1e300};
+    for (int b{0}; b < 5; ++b) {
+        const auto start{Clock::now()};
+        for (size_t i{0}; i < batch; ++i) {
+            run_once();
+        }
+        const double ns{std::chrono::duration<double, std::nano>(Clock::now() - start).count()};
+        best = std::min(best, ns / static_cast<double>(batch));
+    }
+    return best;
+}
+
+struct Fit {
+    double intercept_ns;
+    double ns_per_gas;
+    double r2;
+};
+
+// Least squares of ns against gas
+static Fit fit(const std::vector<const Measurement*>& ms) {
+    const double n{static_cast<double>(ms.size())};
+    double sx{0}, sy{0}, sxx{0}, sxy{0}, syy{0};
+    for (const Measurement* m : ms) {
+        const double x{static_cast<double>(m->gas)};
+        sx += x;
+        sy += m->ns;
+        sxx += x * x;
+        sxy += x * m->ns;
+        syy += m->ns * m->ns;
+    }
+    const double var_x{n * sxx - sx * sx};
+    const double var_y{n * syy - sy * sy};
+    if (n < 2 || var_x <= 0) {
+        return {n ? sy / n : 0, 0, 0};
+    }
+    const double b{(n * sxy - sx * sy) / var_x};
+    const double a{(sy - b * sx) / n};
+    const double cov{n * sxy - sx * sy};
+    return {a, b, var_y > 0 ? cov * cov / (var_x * var_y) : 1};
+}
+
+int main(int argc, char* argv[]) {
+    bool json{false};
+    double min_time_ms{50};
+    double threshold{3};  // flag classes more than threshold times slower than the median
+    for (int i{1}; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strncmp(argv[i], "--min-time-ms=", 14) == 0) {
+            min_time_ms = std::atof(argv[i] + 14);
+        } else if (std::strncmp(argv[i], "--threshold=", 12) == 0) {
+            threshold = std::atof(argv[i] + 12);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--json] [--min-time-ms=N] [--threshold=X]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<InputClass> classes{input_classes()};
+    std::vector<Measurement> ms;
+    for (const InputClass& cls : classes) {
+        const uint64_t gas{cls.impl->gas(cls.input.data(), cls.input.size(), SILKPRE_EVMC_BERLIN)};
+        const double ns{ns_per_call(cls, min_time_ms * 1e6)};
+        ms.push_back({&cls, gas, ns, static_cast<double>(gas) * 1e3 / ns, false});
+    }
+
+    std::vector<double> throughputs;
+    for (const Measurement& m : ms) {
+        if (m.gas) {
+            throughputs.push_back(m.mgas_per_s);
+        }
+    }
+    std::sort(throughputs.begin(), throughputs.end());
+    const double median{throughputs.empty() ? 0 : throughputs[throughputs.size() / 2]};
+    for (Measurement& m : ms) {
+        m.outlier = m.gas && m.mgas_per_s * threshold < median;
+    }
+
+    std::vector<std::pair<const char*, Fit>> fits;
+    for (const InputClass& cls : classes) {
+        if (!fits.empty() && std::strcmp(fits.back().first, cls.contract) == 0) {
+            continue;
+        }
+        std::vector<const Measurement*> same;
+        for (const Measurement& m : ms) {
+            if (std::strcmp(m.cls->contract, cls.contract) == 0) {
+                same.push_back(&m);
+            }
+        }
+        fits.emplace_back(cls.contract, fit(same));
+    }
+
+    if (json) {
+        std::printf("{\n  \"median_mgas_per_s\": %.3f,\n  \"classes\": [\n", median);
+        for (size_t i{0}; i < ms.size(); ++i) {
+            const Measurement& m{ms[i]};
+            std::printf(
+                "    {\"contract\": \"%s\", \"class\": \"%s\", \"input_size\": %zu, \"gas\": %llu, \"ns\": %.1f, "
+                "\"mgas_per_s\": %.3f, \"outlier\": %s}%s\n",
+                m.cls->contract, m.cls->label.c_str(), m.cls->input.size(), static_cast<unsigned long long>(m.gas),
+                m.ns, m.mgas_per_s, m.outlier ? "true" : "false", i + 1 < ms.size() ? "," : "");
+        }
+        std::printf("  ],\n  \"fits\": [\n");
+        for (size_t i{0}; i < fits.size(); ++i) {
+            const auto& [contract, f] = fits[i];
+            std::printf("    {\"contract\": \"%s\", \"intercept_ns\": %.1f, \"ns_per_gas\": %.4f, \"r2\": %.4f}%s\n",
+                        contract, f.intercept_ns, f.ns_per_gas, f.r2, i + 1 < fits.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    } else {
+        std::printf("contract,class,input_size,gas,ns,mgas_per_s,outlier\n");
+        for (const Measurement& m : ms) {
+            std::printf("%s,%s,%zu,%llu,%.1f,%.3f,%s\n", m.cls->contract, m.cls->label.c_str(), m.cls->input.size(),
+                        static_cast<unsigned long long>(m.gas), m.ns, m.mgas_per_s, m.outlier ? "SLOW" : "");
+        }
+        std::printf("\ncontract,intercept_ns,ns_per_gas,r2\n");
+        for (const auto& [contract, f] : fits) {
+            std::printf("%s,%.1f,%.4f,%.4f\n", contract, f.intercept_ns, f.ns_per_gas, f.r2);
+        }
+        std::printf("\n# median %.3f Mgas/s; SLOW = below median / %.1f\n", median, threshold);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "inputs.hpp"
+
+#include "hex.hpp"
+
+std::basic_string<uint8_t> random_bytes(size_t len, uint64_t seed) {
+    std::basic_string<uint8_t> out(len, 0);
+    uint64_t x{seed};
+    for (size_t i{0}; i < len; ++i) {
+        // splitmix64
+        x += 0x9e3779b97f4a7c15;
+        uint64_t z{x};
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        out[i] = static_cast<uint8_t>(z ^ (z >> 31));
+    }
+    return out;
+}
+
+std::basic_string<uint8_t> ecrec_input() {
+    return from_hex(
+        "18c547e4f7b0f325ad1e56f57e26c745b09a3e503d86e00e5255ff7f715d3d1c0000000000000000000000000000"
+        "00000000000000000000000000000000001c73b1693892219d736caba55bdb67216e485557ea6b6af75f37096c9a"
+        "a6a5a75feeb940b1d03b21e36b0e47e79769f095fe2ab855bd91e3a38756b7d75a9c4549");
+}
+
+static void append_length(std::basic_string<uint8_t>& out, size_t len) {
+    uint8_t word[32]{};
+    for (size_t i{0}; i < sizeof(len); ++i) {
+        word[31 - i] = static_cast<uint8_t>(len >> (8 * i));
+    }
+    out.append(word, sizeof(word));
+}
+
+std::basic_string<uint8_t> expmod_input(size_t base_len, const std::basic_string<uint8_t>& exp, size_t mod_len,
+                                        bool odd_modulus) {
+    std::basic_string<uint8_t> out;
+    append_length(out, base_len);
+    append_length(out, exp.length());
+    append_length(out, mod_len);
+    out += random_bytes(base_len, 2);
+    out += exp;
+    std::basic_string<uint8_t> mod{random_bytes(mod_len, 3)};
+    if (mod_len) {
+        mod[0] |= 0x80;
+        if (odd_modulus) {
+            mod[mod_len - 1] |= 1;
+        } else {
+            mod[mod_len - 1] &= 0xfe;
+        }
+    }
+    out += mod;
+    return out;
+}
+
+std::basic_string<uint8_t> bn_add_input() {
+    return from_hex(
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000002"
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000002");
+}
+
+std::basic_string<uint8_t> bn_mul_input() {
+    return from_hex(
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000002"
+        "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000000");
+}
+
+std::basic_string<uint8_t> bn_mul_variable_base_input() {
+    return from_hex(
+        "030644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd3"
+        "15ed738c0e0a7c92e7845f96b2ae9c0a68a6a449e3538fc7ff3ebf7a5a18a2c4"
+        "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000000");
+}
+
+std::basic_string<uint8_t> snarkv_input(size_t pairs) {
+    static const std::basic_string<uint8_t> kTwoPairs{from_hex(
+        "0f25929bcb43d5a57391564615c9e70a992b10eafa4db109709649cf48c50dd216da2f5cb6be7a0aa72c440c53c9"
+        "bbdfec6c36c7d515536431b3a865468acbba2e89718ad33c8bed92e210e81d1853435399a271913a6520736a4729"
+        "cf0d51eb01a9e2ffa2e92599b68e44de5bcf354fa2642bd4f26b259daa6f7ce3ed57aeb314a9a87b789a58af499b"
+        "314e13c3d65bede56c07ea2d418d6874857b70763713178fb49a2d6cd347dc58973ff49613a20757d0fcc22079f9"
+        "abd10c3baee245901b9e027bd5cfc2cb5db82d4dc9677ac795ec500ecd47deee3b5da006d6d049b811d7511c7815"
+        "8de484232fc68daf8a45cf217d1c2fae693ff5871e8752d73b21198e9393920d483a7260bfb731fb5d25f1aa4933"
+        "35a9e71297e485b7aef312c21800deef121f1e76426a00665e5c4479674322d4f75edadd46debd5cd992f6ed0906"
+        "89d0585ff075ec9e99ad690c3395bc4b313370b38ef355acdadcd122975b12c85ea5db8c6deb4aab71808dcb408f"
+        "e3d1e7690c43d37b4ce6cc0166fa7daa")};
+    constexpr size_t kPairSize{192};
+    std::basic_string<uint8_t> out;
+    for (size_t i{0}; i < pairs; ++i) {
+        out.append(kTwoPairs, (i % 2) * kPairSize, kPairSize);
+    }
+    return out;
+}
+
+std::basic_string<uint8_t> blake2_f_input(uint32_t rounds) {
+    std::basic_string<uint8_t> out{from_hex(
+        "0000000c48c9bdf267e6096a3ba7ca8485ae67bb2bf894fe72f36e3cf1361d5f3af54fa5d182e6ad7f520e511f6c3e"
+        "2b8c68059b6bbd41fbabd9831f79217e1319cde05b61626300000000000000000000000000000000000000000000"
+        "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "00000000000000000000000300000000000000000000000000000001")};
+    for (size_t i{0}; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(rounds >> (24 - 8 * i));
+    }
+    return out;
+}
+
+std::basic_string<uint8_t> p256verify_input() {
+    return from_hex(
+        "6443552c7ae8d92f8bc4a90c9666424c36b3edd8151fd88b7e82a755e1a5e0f0"
+        "b2e09bb61647f28a702e41b3900806290f60dc0d4f0853fd0fc310f5fbcf5a0d"
+        "15af9d310be13c666d22dc3651156866e11c53f2257f38ed94f05ddfd28dacd0"
+        "3bab51735ddd0cd5ff9bab32a922fa885dd1a19cd0a2c2e08c284cc8b377dba1"
+        "d696a07cb1936a2738cd036843da1585ce9a09e88e09bc365e10ef8411206ec6");
+}
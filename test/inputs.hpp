@@ -0,0 +1,56 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKPRE_INPUTS_HPP_
+#define SILKPRE_INPUTS_HPP_
+
+// Representative and worst-case precompile inputs shared by the benchmarks and tools
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+// Deterministic pseudo-random bytes
+std::basic_string<uint8_t> random_bytes(size_t len, uint64_t seed = 1);
+
+std::basic_string<uint8_t> ecrec_input();
+
+//! \brief EIP-198 input with random base and modulus
+//! \param [in] exp : big-endian exponent
+//! \param [in] odd_modulus : whether the lowest bit of the modulus is set; the top bit always is
+std::basic_string<uint8_t> expmod_input(size_t base_len, const std::basic_string<uint8_t>& exp, size_t mod_len,
+                                        bool odd_modulus);
+
+// G1 generator + G1 generator
+std::basic_string<uint8_t> bn_add_input();
+
+// G1 generator times a full-width scalar
+std::basic_string<uint8_t> bn_mul_input();
+
+// Same scalar times 2G, which takes the variable-base path rather than the generator's table
+std::basic_string<uint8_t> bn_mul_variable_base_input();
+
+// Valid (G1, G2) pairs; the pairing result is irrelevant
+std::basic_string<uint8_t> snarkv_input(size_t pairs);
+
+// EIP-152 test vector 5 with the given number of rounds
+std::basic_string<uint8_t> blake2_f_input(uint32_t rounds);
+
+// A valid signature
+std::basic_string<uint8_t> p256verify_input();
+
+#endif  // SILKPRE_INPUTS_HPP_
@@ -0,0 +1,66 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/keccak.h>
+
+#include "hex.hpp"
+
+TEST_CASE("Keccak256") {
+    uint8_t hash[32];
+    silkpre_keccak256(hash, nullptr, 0);
+    CHECK(to_hex(hash, 32) == "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470");
+
+    const std::basic_string<uint8_t> abc{from_hex("616263")};
+    silkpre_keccak256(hash, abc.data(), abc.length());
+    CHECK(to_hex(hash, 32) == "4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45");
+}
+
+TEST_CASE("Keccak256 incremental") {
+    constexpr size_t kRate{SILKPRE_KECCAK256_RATE};
+    std::basic_string<uint8_t> input;
+    for (size_t i{0}; i < 3 * kRate + 5; ++i) {
+        input.push_back(static_cast<uint8_t>(i * 7));
+    }
+
+    for (size_t len : {kRate - 1, kRate, input.length()}) {
+        uint8_t expected[32];
+        silkpre_keccak256(expected, input.data(), len);
+        for (size_t split : {size_t{0}, size_t{1}, len / 2, len - 1, len}) {
+            SilkpreKeccak256 ctx;
+            silkpre_keccak256_init(&ctx);
+            silkpre_keccak256_update(&ctx, input.data(), split);
+            silkpre_keccak256_update(&ctx, input.data() + split, len - split);
+            uint8_t hash[32];
+            silkpre_keccak256_final(&ctx, hash);
+            CHECK(to_hex(hash, 32) == to_hex(expected, 32));
+        }
+    }
+
+    // Byte by byte across block boundaries
+    const std::basic_string<uint8_t> x(300, 'x');
+    SilkpreKeccak256 ctx;
+    silkpre_keccak256_init(&ctx);
+    for (uint8_t c : x) {
+        silkpre_keccak256_update(&ctx, &c, 1);
+    }
+    uint8_t hash[32];
+    silkpre_keccak256_final(&ctx, hash);
+    CHECK(to_hex(hash, 32) == "956875d0d3af4718863b89e475911881cebd1cd08cfe3c2fcd0890d29def1e37");
+}
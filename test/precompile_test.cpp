@@ -16,15 +16,13 @@
 
 #include <catch2/catch.hpp>
 
+#include <silkpre/copy.h>
+#include <silkpre/montgomery.h>
+#include <silkpre/p256.h>
 #include <silkpre/precompile.h>
 
 #include "hex.hpp"
 
-enum {
-    EVMC_BYZANTIUM = 4,
-    EVMC_BERLIN = 8,
-};
-
 TEST_CASE("Ecrecover") {
     std::basic_string<uint8_t> in{
         from_hex("18c547e4f7b0f325ad1e56f57e26c745b09a3e503d86e00e5255ff7f715d3d1c0000000000000000000000000000"
@@ -76,7 +74,7 @@ TEST_CASE("EXPMOD") {
                  "03"
                  "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
                  "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f")};
-    CHECK(silkpre_expmod_gas(in.data(), in.length(), EVMC_BYZANTIUM) == 13056);
+    CHECK(silkpre_expmod_gas(in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM) == 13056);
 
     SilkpreOutput out{silkpre_expmod_run(in.data(), in.length())};
     REQUIRE(out.data);
@@ -101,8 +99,8 @@ TEST_CASE("EXPMOD") {
         "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
         "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
         "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffd");
-    CHECK(silkpre_expmod_gas(in.data(), in.length(), EVMC_BYZANTIUM) == UINT64_MAX);
-    CHECK(silkpre_expmod_gas(in.data(), in.length(), EVMC_BERLIN) == UINT64_MAX);
+    CHECK(silkpre_expmod_gas(in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM) == UINT64_MAX);
+    CHECK(silkpre_expmod_gas(in.data(), in.length(), SILKPRE_EVMC_BERLIN) == UINT64_MAX);
 
     in = from_hex(
         "0000000000000000000000000000000000000000000000000000000000000100"
@@ -121,8 +119,27 @@ TEST_CASE("EXPMOD") {
         "1c9d571616e1cbeef439413f348f9c6e89226a971b393fc8d45472951d68897eaf264acdbb5cd54b6c4ea520b45c"
         "3abbbd78fa27dd113921d3facbcc1d6040243c9761867c69a1dc13d9f71898121ff696561458d9d9f87536d6a84f"
         "b602c91f9b07e561fa2f54eb0f9f1984f3cbe728ec142cbed52f");
-    CHECK(silkpre_expmod_gas(in.data(), in.length(), EVMC_BYZANTIUM) == 30310);
-    CHECK(silkpre_expmod_gas(in.data(), in.length(), EVMC_BERLIN) == 5461);
+    CHECK(silkpre_expmod_gas(in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM) == 30310);
+    CHECK(silkpre_expmod_gas(in.data(), in.length(), SILKPRE_EVMC_BERLIN) == 5461);
+
+    // RSA-2048 signature check; the Montgomery context of the modulus is reused by the second run
+    SilkpreCacheStats before{};
+    silkpre_montgomery_cache_stats(&before);
+    for (int i{0}; i < 2; ++i) {
+        out = silkpre_expmod_run(in.data(), in.length());
+        REQUIRE(out.data);
+        CHECK(to_hex(out.data, out.size) ==
+              "0001ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+              "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+              "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+              "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+              "ffffffffffffffffffffffffffffffff003031300d06096086480165030402010500042054220de2ce7bfbcbaae283"
+              "0a138aa841b269101fd2ded46f3fcbdd6644b259bd");
+        std::free(out.data);
+    }
+    SilkpreCacheStats after{};
+    silkpre_montgomery_cache_stats(&after);
+    CHECK(after.hits > before.hits);
 }
 
 TEST_CASE("BN_ADD") {
@@ -151,6 +168,37 @@ TEST_CASE("BN_MUL") {
     std::free(out.data);
 }
 
+TEST_CASE("BN_MUL of the generator") {
+    const std::string generator{
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000002"};
+    const auto mul{[](const std::string& point, const std::string& scalar) {
+        const std::basic_string<uint8_t> in{from_hex(point + scalar)};
+        SilkpreOutput out{silkpre_bn_mul_run(in.data(), in.length())};
+        REQUIRE(out.data);
+        const std::string res{to_hex(out.data, out.size)};
+        std::free(out.data);
+        return res;
+    }};
+
+    CHECK(mul(generator, "0000000000000000000000000000000000000000000000000000000000000009") ==
+          "039730ea8dff1254c0fee9c0ea777d29a9c710b7e616683f194f18c43b43b869"
+          "073a5ffcc6fc7a28c30723d6e58ce577356982d65b833a5a5c15bf9024b43d98");
+    CHECK(mul(generator, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff") ==
+          "2f588cffe99db877a4434b598ab28f81e0522910ea52b45f0adaa772b2d5d352"
+          "12f42fa8fd34fb1b33d8c6a718b6590198389b26fc9d8808d971f8b009777a97");
+    // group order
+    CHECK(mul(generator, "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000001") == std::string(128, '0'));
+    CHECK(mul(generator, "") == std::string(128, '0'));
+
+    // Same as the variable-base multiplication of 2G by half the scalar
+    const std::string doubled{
+        "030644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd3"
+        "15ed738c0e0a7c92e7845f96b2ae9c0a68a6a449e3538fc7ff3ebf7a5a18a2c4"};
+    CHECK(mul(generator, "1f2e3d4c5b6a79880f1e2d3c4b5a69788796a5b4c3d2e1f00112233445566778") ==
+          mul(doubled, "0f971ea62db53cc4078f169e25ad34bc43cb52da61e970f80089119a22ab33bc"));
+}
+
 TEST_CASE("SNARKV") {
     // empty input
     std::basic_string<uint8_t> in{};
@@ -272,3 +320,203 @@ TEST_CASE("BLAKE2") {
           "d53923de3d64fcc68c034e717b9293fed7a421");
     std::free(out.data);
 }
+
+TEST_CASE("P256VERIFY") {
+    // hash, r, s, qx, qy
+    std::basic_string<uint8_t> in{from_hex(
+        "6443552c7ae8d92f8bc4a90c9666424c36b3edd8151fd88b7e82a755e1a5e0f0"
+        "b2e09bb61647f28a702e41b3900806290f60dc0d4f0853fd0fc310f5fbcf5a0d"
+        "15af9d310be13c666d22dc3651156866e11c53f2257f38ed94f05ddfd28dacd0"
+        "3bab51735ddd0cd5ff9bab32a922fa885dd1a19cd0a2c2e08c284cc8b377dba1"
+        "d696a07cb1936a2738cd036843da1585ce9a09e88e09bc365e10ef8411206ec6")};
+    CHECK(silkpre_p256verify_gas(in.data(), in.length(), 0) == 3450);
+
+    SilkpreOutput out{silkpre_p256verify_run(in.data(), in.length())};
+    REQUIRE(out.data);
+    CHECK(to_hex(out.data, out.size) == "0000000000000000000000000000000000000000000000000000000000000001");
+    std::free(out.data);
+
+    // wrong input length
+    out = silkpre_p256verify_run(in.data(), in.length() - 1);
+    CHECK((out.data != nullptr && out.size == 0));
+    std::free(out.data);
+
+    // tampered hash
+    in[5] ^= 1;
+    out = silkpre_p256verify_run(in.data(), in.length());
+    CHECK((out.data != nullptr && out.size == 0));
+    std::free(out.data);
+    in[5] ^= 1;
+
+    // s = 0
+    std::basic_string<uint8_t> invalid{in};
+    std::fill_n(&invalid[64], 32, 0);
+    out = silkpre_p256verify_run(invalid.data(), invalid.length());
+    CHECK((out.data != nullptr && out.size == 0));
+    std::free(out.data);
+
+    // public key not on the curve
+    invalid = in;
+    invalid[159] ^= 1;
+    out = silkpre_p256verify_run(invalid.data(), invalid.length());
+    CHECK((out.data != nullptr && out.size == 0));
+    std::free(out.data);
+
+    const std::basic_string<uint8_t> valid1{from_hex(
+        "18eda0c0207802a4bea1a1f6acd9512b1cc4bf8557975499c8dfe5f7f8b4b3be"
+        "3b7504c9c6ff4998ff3ef39ac5f85df0d25ec4d221e45007b5e579e77302f953"
+        "a82eabe2ae5010a0805aaf918727f7f71c4cc1ac9cec92a533e3dad0064bd042"
+        "b1fd322a2632a39a8cf2ed59904fd6bbf02cdca1d132b625e8967f10f4fb01e7"
+        "aabd0ab694dcacd5bbc9dbc01918b84cb2f6da45f8979f1efe99f7575060902f")};
+    const std::basic_string<uint8_t> valid2{from_hex(
+        "1ac2e168886100a2d61a48524d30cafe7d06bbc32a760d4082eb7771dbae5f2a"
+        "8a720a4c2832337cd50c8a7caf20ac2bba86b17320e68a2159984da486b36705"
+        "8e6707c0339e3cf57443e54d7fd90bf84d0ccff75b6d155e2a0eb22da7f186ea"
+        "01d8952ee8af8f4fc9dd802b1cdc3e40f70372ee93cae935c0e56ae8a97ccb12"
+        "e795b911eba189d8b1677d527f74572cbce3aa669c1e1ea4e9f048375949e74c")};
+
+    const std::basic_string<uint8_t> batch{in + valid1 + invalid + valid2};
+    bool results[4];
+    silkpre_p256_verify_batch(results, batch.data(), 4);
+    CHECK(results[0]);
+    CHECK(results[1]);
+    CHECK(!results[2]);
+    CHECK(results[3]);
+}
+
+TEST_CASE("Init") {
+    silkpre_init(SILKPRE_INIT_ALL);
+    silkpre_init(SILKPRE_INIT_ALL);  // idempotent
+
+    const std::basic_string<uint8_t> in(160, 0);
+    SilkpreOutput out{silkpre_p256verify_run(in.data(), in.length())};
+    CHECK((out.data && out.size == 0));
+    std::free(out.data);
+}
+
+TEST_CASE("Registry") {
+    // Not kSilkpreContracts, whose entries may be instrumented
+    static const SilkpreContract kRaw[SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS]{
+        {silkpre_ecrec_gas, silkpre_ecrec_run},       {silkpre_sha256_gas, silkpre_sha256_run},
+        {silkpre_rip160_gas, silkpre_rip160_run},     {silkpre_id_gas, silkpre_id_run},
+        {silkpre_expmod_gas, silkpre_expmod_run},     {silkpre_bn_add_gas, silkpre_bn_add_run},
+        {silkpre_bn_mul_gas, silkpre_bn_mul_run},     {silkpre_snarkv_gas, silkpre_snarkv_run},
+        {silkpre_blake2_f_gas, silkpre_blake2_f_run},
+    };
+
+    uint8_t address[20]{};
+    for (uint8_t i{0}; i < 16; ++i) {
+        address[19] = i;
+        for (int rev{SILKPRE_EVMC_FRONTIER}; rev <= SILKPRE_EVMC_BERLIN + 4; ++rev) {
+            const SilkpreContractDescriptor* contract{silkpre_lookup(address, rev)};
+            size_t n{SILKPRE_NUMBER_OF_FRONTIER_CONTRACTS};
+            if (rev >= SILKPRE_EVMC_ISTANBUL) {
+                n = SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS;
+            } else if (rev >= SILKPRE_EVMC_BYZANTIUM) {
+                n = SILKPRE_NUMBER_OF_BYZANTIUM_CONTRACTS;
+            }
+            if (i == 0 || i > n) {
+                CHECK(!contract);
+                continue;
+            }
+            REQUIRE(contract);
+            CHECK(contract->address == i);
+            CHECK(contract->index == i - 1u);
+            CHECK(contract->gas == kRaw[i - 1].gas);
+            CHECK(contract->run == kRaw[i - 1].run);
+            CHECK(contract == silkpre_contract_descriptor(i - 1));
+        }
+    }
+
+    address[19] = 1;
+    address[0] = 1;
+    CHECK(!silkpre_lookup(address, SILKPRE_EVMC_BERLIN));
+
+    address[0] = 0;
+    address[18] = SILKPRE_P256VERIFY_ADDRESS >> 8;
+    address[19] = SILKPRE_P256VERIFY_ADDRESS & 0xff;
+    CHECK(!silkpre_lookup(address, SILKPRE_EVMC_BERLIN));
+
+    const SilkpreContractDescriptor* p256{silkpre_contract_descriptor(SILKPRE_NUMBER_OF_CONTRACTS - 1)};
+    REQUIRE(p256);
+    CHECK(p256->address == SILKPRE_P256VERIFY_ADDRESS);
+    CHECK(p256->run == silkpre_p256verify_run);
+    CHECK(!silkpre_contract_descriptor(SILKPRE_NUMBER_OF_CONTRACTS));
+}
+
+TEST_CASE("Execute") {
+    const SilkpreContractDescriptor* expmod{silkpre_contract_descriptor(4)};
+    REQUIRE(expmod);
+
+    std::basic_string<uint8_t> in{
+        from_hex("0000000000000000000000000000000000000000000000000000000000000001"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "03"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f")};
+
+    uint64_t gas_used{0};
+    SilkpreOutput out{};
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 13055, &gas_used, &out) ==
+          SILKPRE_OUT_OF_GAS);
+    CHECK(gas_used == 13055);
+    CHECK(!out.data);
+
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 13056, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    CHECK(gas_used == 13056);
+    REQUIRE(out.data);
+    CHECK(to_hex(out.data, out.size) == "0000000000000000000000000000000000000000000000000000000000000001");
+    std::free(out.data);
+
+    // Huge modulus length is rejected without touching the (absent) modulus
+    in = from_hex(
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "00000000000000000000000000000000000000000000000000000000ffffffff"
+        "0203");
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 30'000'000, &gas_used, &out) ==
+          SILKPRE_OUT_OF_GAS);
+    CHECK(!out.data);
+
+    const SilkpreContractDescriptor* snarkv{silkpre_contract_descriptor(7)};
+    REQUIRE(snarkv);
+    in = from_hex("ab");
+    CHECK(silkpre_execute(snarkv, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 1'000'000, &gas_used, &out) ==
+          SILKPRE_INVALID_INPUT);
+    CHECK(gas_used == 1'000'000);
+    CHECK(!out.data);
+
+    const SilkpreContractDescriptor* id{silkpre_contract_descriptor(3)};
+    REQUIRE(id);
+    CHECK(silkpre_execute(id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 100, &gas_used, &out) == SILKPRE_SUCCESS);
+    CHECK(gas_used == 18);
+    REQUIRE(out.data);
+    CHECK(to_hex(out.data, out.size) == "ab");
+    std::free(out.data);
+
+    // The borrowed output of identity is the input itself
+    SilkpreView view{};
+    CHECK(silkpre_execute_view(id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 17, &gas_used, &view) ==
+          SILKPRE_OUT_OF_GAS);
+    CHECK(gas_used == 17);
+    CHECK(!view.data);
+    CHECK(silkpre_execute_view(id, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 100, &gas_used, &view) ==
+          SILKPRE_SUCCESS);
+    CHECK(gas_used == 18);
+    CHECK(view.data == in.data());
+    CHECK(view.size == in.length());
+    CHECK(!snarkv->view);
+
+    // Large enough to take the streaming copy, with an odd length and a misaligned source
+    const std::basic_string<uint8_t> large(SILKPRE_STREAMING_COPY_THRESHOLD + 77, 0x5a);
+    in = large;
+    for (size_t i{0}; i < in.length(); i += 4093) {
+        in[i] = static_cast<uint8_t>(i);
+    }
+    out = id->run(in.data() + 1, in.length() - 1);
+    REQUIRE(out.size == in.length() - 1);
+    CHECK(std::basic_string<uint8_t>(out.data, out.size) == in.substr(1));
+    std::free(out.data);
+}
@@ -0,0 +1,154 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/precompile.h>
+#include <silkpre/prefetch.h>
+
+#include "hex.hpp"
+
+static void wait_for_executed(uint64_t n) {
+    SilkprePrefetchStats stats{};
+    for (int i{0}; i < 1000; ++i) {
+        silkpre_prefetch_stats(&stats);
+        if (stats.executed >= n) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    FAIL("hints weren't pre-executed in time");
+}
+
+TEST_CASE("Prefetched execute") {
+    uint8_t address[20]{};
+    address[19] = 0x05;  // modexp
+    const std::basic_string<uint8_t> in{
+        from_hex("0000000000000000000000000000000000000000000000000000000000000001"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "0000000000000000000000000000000000000000000000000000000000000020"
+                 "03"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+                 "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f")};
+
+    CHECK(!silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM));
+
+    REQUIRE(silkpre_prefetch_start(1 << 20, 16, 1));
+    CHECK(!silkpre_prefetch_start(1 << 20, 16, 1));
+
+    // Not activated yet
+    CHECK(!silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_FRONTIER));
+    // Hash-like contracts aren't worth it
+    uint8_t sha256_address[20]{};
+    sha256_address[19] = 0x02;
+    CHECK(!silkpre_prefetch_hint(sha256_address, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM));
+
+    CHECK(silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM));
+    wait_for_executed(1);
+
+    const SilkpreContractDescriptor* expmod{silkpre_lookup(address, SILKPRE_EVMC_BYZANTIUM)};
+    REQUIRE(expmod);
+    uint64_t gas_used{0};
+    SilkpreOutput out{};
+
+    // Out of gas is decided before the lookup
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 13055, &gas_used, &out) ==
+          SILKPRE_OUT_OF_GAS);
+    CHECK(gas_used == 13055);
+    CHECK(!out.data);
+
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM, 20'000, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    CHECK(gas_used == 13056);
+    REQUIRE(out.data);
+    CHECK(to_hex(out.data, out.size) == "0000000000000000000000000000000000000000000000000000000000000001");
+    std::free(out.data);
+
+    // Gas is charged by the revision of the call rather than of the hint
+    CHECK(silkpre_execute(expmod, in.data(), in.length(), SILKPRE_EVMC_BERLIN, 20'000, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    CHECK(gas_used == 1360);
+    REQUIRE(out.data);
+    std::free(out.data);
+
+    const std::basic_string<uint8_t> other{in.substr(0, in.length() - 1) + uint8_t{0x2d}};
+    CHECK(silkpre_execute(expmod, other.data(), other.length(), SILKPRE_EVMC_BYZANTIUM, 20'000, &gas_used, &out) ==
+          SILKPRE_SUCCESS);
+    std::free(out.data);
+
+    SilkprePrefetchStats stats{};
+    silkpre_prefetch_stats(&stats);
+    CHECK(stats.hints == 1);
+    CHECK(stats.dropped == 0);
+    CHECK(stats.executed == 1);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 1);
+
+    silkpre_prefetch_stop();
+    silkpre_prefetch_stop();
+    silkpre_prefetch_stats(&stats);
+    CHECK(stats.hints == 0);
+    CHECK(stats.hits == 0);
+    CHECK(!silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_BYZANTIUM));
+}
+
+TEST_CASE("Prefetch backlog") {
+    uint8_t address[20]{};
+    address[19] = 0x05;
+    const std::basic_string<uint8_t> in(96, 0);
+
+    REQUIRE(silkpre_prefetch_start(1 << 20, /*max_pending=*/0, 1));
+    CHECK(!silkpre_prefetch_hint(address, in.data(), in.length(), SILKPRE_EVMC_BERLIN));
+
+    SilkprePrefetchStats stats{};
+    silkpre_prefetch_stats(&stats);
+    CHECK(stats.hints == 0);
+    CHECK(stats.dropped == 1);
+    silkpre_prefetch_stop();
+}
+
+TEST_CASE("Prefetch gas cap") {
+    uint8_t address[20]{};
+    address[19] = 0x05;
+    // modexp of a 2^40-byte modulus: the gas check must reject it before anything gets allocated
+    const std::basic_string<uint8_t> huge{
+        from_hex("0000000000000000000000000000000000000000000000000000000000000000"
+                 "0000000000000000000000000000000000000000000000000000000000000000"
+                 "0000000000000000000000000000000000000000000000000000010000000000")};
+    const std::basic_string<uint8_t> small(96, 0);
+
+    REQUIRE(silkpre_prefetch_start(1 << 20, 16, 1));
+    CHECK(!silkpre_prefetch_hint(address, huge.data(), huge.length(), SILKPRE_EVMC_BERLIN));
+    CHECK(!silkpre_prefetch_hint(address, huge.data(), huge.length(), SILKPRE_EVMC_BYZANTIUM));
+
+    silkpre_prefetch_set_max_gas(100);
+    CHECK(!silkpre_prefetch_hint(address, small.data(), small.length(), SILKPRE_EVMC_BERLIN));  // 200 gas
+    silkpre_prefetch_set_max_gas(SILKPRE_PREFETCH_DEFAULT_MAX_GAS);
+    CHECK(silkpre_prefetch_hint(address, small.data(), small.length(), SILKPRE_EVMC_BERLIN));
+    wait_for_executed(1);
+
+    SilkprePrefetchStats stats{};
+    silkpre_prefetch_stats(&stats);
+    CHECK(stats.hints == 1);
+    CHECK(stats.over_gas == 3);
+    CHECK(stats.executed == 1);
+    silkpre_prefetch_stop();
+}
@@ -0,0 +1,343 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Replays a corpus of recorded precompile calls through kSilkpreContracts, first on one
+// thread and then on N, reporting throughput, per-contract time share and output checksums.
+// Checksums don't depend on the execution order, so they must match between runs and builds.
+//
+// Corpus format: a flat sequence of records, all integers little-endian
+//   uint16 address     precompile address, e.g. 5 for modexp or 0x100 for P256VERIFY
+//   uint8  revision    evmc_revision
+//   uint8  reserved    0
+//   uint32 length      input length
+//   uint8  input[length]
+//
+// Usage: replay <corpus> [--threads=N]
+//        replay --generate <corpus>   writes a small synthetic corpus
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <silkpre/precompile.h>
+
+#include "inputs.hpp"
+
+namespace {
+
+constexpr size_t kRecordHeaderSize{8};
+
+struct Record {
+    const SilkpreContract* contract;
+    size_t index;  // SilkpreContractDescriptor::index
+    int revision;
+    const uint8_t* input;
+    size_t len;
+};
+
+// Read-only view of a whole file
+class MappedFile {
+  public:
+    explicit MappedFile(const char* path) {
+#if defined(_WIN32)
+        std::ifstream in{path, std::ios::binary};
+        buffer_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        ok_ = in.good() || in.eof();
+        data_ = reinterpret_cast<const uint8_t*>(buffer_.data());
+        size_ = buffer_.size();
+#else
+        const int fd{::open(path, O_RDONLY)};
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) == 0) {
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ == 0) {
+                ok_ = true;
+            } else if (void* p{::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)}; p != MAP_FAILED) {
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const uint8_t*>(p);
+                ok_ = true;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (data_) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ok() const noexcept { return ok_; }
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+
+  private:
+#if defined(_WIN32)
+    std::string buffer_;
+#endif
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+    bool ok_{false};
+};
+
+uint32_t load_le(const uint8_t* p, size_t n) noexcept {
+    uint32_t x{0};
+    for (size_t i{0}; i < n; ++i) {
+        x |= static_cast<uint32_t>(p[i]) << (8 * i);
+    }
+    return x;
+}
+
+bool parse(const MappedFile& file, std::vector<Record>& records) {
+    const uint8_t* p{file.data()};
+    const uint8_t* end{p + file.size()};
+    while (p != end) {
+        if (static_cast<size_t>(end - p) < kRecordHeaderSize) {
+            return false;
+        }
+        const uint32_t address{load_le(p, 2)};
+        const int revision{p[2]};
+        const size_t len{load_le(p + 4, 4)};
+        p += kRecordHeaderSize;
+        if (static_cast<size_t>(end - p) < len) {
+            return false;
+        }
+        uint8_t address_bytes[20]{};
+        address_bytes[18] = static_cast<uint8_t>(address >> 8);
+        address_bytes[19] = static_cast<uint8_t>(address);
+        const SilkpreContractDescriptor* desc{silkpre_lookup(address_bytes, revision)};
+        if (!desc && address == SILKPRE_P256VERIFY_ADDRESS) {
+            desc = silkpre_contract_descriptor(SILKPRE_NUMBER_OF_CONTRACTS - 1);
+        }
+        if (desc) {
+            const SilkpreContract* contract{desc->index < SILKPRE_NUMBER_OF_ISTANBUL_CONTRACTS
+                                                ? &kSilkpreContracts[desc->index]
+                                                : &kSilkpreP256VerifyContract};
+            records.push_back({contract, desc->index, revision, p, len});
+        }
+        p += len;
+    }
+    return true;
+}
+
+uint64_t fnv1a(uint64_t h, const uint8_t* data, size_t len) noexcept {
+    for (size_t i{0}; i < len; ++i) {
+        h = (h ^ data[i]) * 0x100000001b3;
+    }
+    return h;
+}
+
+struct ContractTotals {
+    uint64_t calls{0};
+    uint64_t gas{0};
+    double ns{0};
+    uint64_t checksum{0};  // sum of per-record hashes, independent of the order
+
+    void merge(const ContractTotals& other) noexcept {
+        calls += other.calls;
+        gas += other.gas;
+        ns += other.ns;
+        checksum += other.checksum;
+    }
+};
+
+using Totals = std::vector<ContractTotals>;
+
+void execute(const Record& r, size_t record_index, ContractTotals& totals) {
+    const auto start{std::chrono::steady_clock::now()};
+    const uint64_t gas{r.contract->gas(r.input, r.len, r.revision)};
+    SilkpreOutput out{r.contract->run(r.input, r.len)};
+    const auto stop{std::chrono::steady_clock::now()};
+
+    uint64_t h{0xcbf29ce484222325};
+    const uint64_t n{record_index};
+    h = fnv1a(h, reinterpret_cast<const uint8_t*>(&n), sizeof(n));
+    const uint8_t ok{out.data != nullptr};
+    h = fnv1a(h, &ok, 1);
+    if (out.data) {
+        h = fnv1a(h, out.data, out.size);
+    }
+    std::free(out.data);
+
+    ++totals.calls;
+    totals.gas += gas;
+    totals.ns += std::chrono::duration<double, std::nano>(stop - start).count();
+    totals.checksum += h;
+}
+
+double replay(const std::vector<Record>& records, size_t num_threads, Totals& totals) {
+    constexpr size_t kChunk{256};
+    std::atomic<size_t> next{0};
+    std::vector<Totals> per_thread(num_threads, Totals(SILKPRE_NUMBER_OF_CONTRACTS));
+    const auto worker{[&](Totals& t) {
+        for (size_t begin; (begin = next.fetch_add(kChunk, std::memory_order_relaxed)) < records.size();) {
+            const size_t end{std::min(begin + kChunk, records.size())};
+            for (size_t i{begin}; i < end; ++i) {
+                execute(records[i], i, t[records[i].index]);
+            }
+        }
+    }};
+
+    const auto start{std::chrono::steady_clock::now()};
+    std::vector<std::thread> threads;
+    for (size_t i{1}; i < num_threads; ++i) {
+        threads.emplace_back(worker, std::ref(per_thread[i]));
+    }
+    worker(per_thread[0]);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    const double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    totals.assign(SILKPRE_NUMBER_OF_CONTRACTS, {});
+    for (const Totals& t : per_thread) {
+        for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+            totals[i].merge(t[i]);
+        }
+    }
+    return seconds;
+}
+
+void report(const char* mode, size_t num_threads, double seconds, const Totals& totals) {
+    ContractTotals all;
+    for (const ContractTotals& t : totals) {
+        all.merge(t);
+    }
+    std::printf("%s (%zu thread%s): %llu calls in %.3f s, %.0f calls/s, %.1f Mgas/s, checksum %016llx\n", mode,
+                num_threads, num_threads == 1 ? "" : "s", static_cast<unsigned long long>(all.calls), seconds,
+                static_cast<double>(all.calls) / seconds, static_cast<double>(all.gas) / seconds / 1e6,
+                static_cast<unsigned long long>(all.checksum));
+    std::printf("  %-14s %10s %8s %12s %18s\n", "contract", "calls", "time%", "Mgas/s", "checksum");
+    for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+        const ContractTotals& t{totals[i]};
+        if (!t.calls) {
+            continue;
+        }
+        std::printf("  %-14s %10llu %7.2f%% %12.1f   %016llx\n", silkpre_contract_descriptor(i)->name,
+                    static_cast<unsigned long long>(t.calls), all.ns > 0 ? 100 * t.ns / all.ns : 0,
+                    t.ns > 0 ? static_cast<double>(t.gas) * 1e3 / t.ns : 0,
+                    static_cast<unsigned long long>(t.checksum));
+    }
+}
+
+void append_record(std::ofstream& out, uint16_t address, uint8_t revision, const std::basic_string<uint8_t>& input) {
+    const uint32_t len{static_cast<uint32_t>(input.size())};
+    const uint8_t header[kRecordHeaderSize]{
+        static_cast<uint8_t>(address),   static_cast<uint8_t>(address >> 8), revision, 0,
+        static_cast<uint8_t>(len),       static_cast<uint8_t>(len >> 8),     static_cast<uint8_t>(len >> 16),
+        static_cast<uint8_t>(len >> 24),
+    };
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(input.data()), static_cast<std::streamsize>(input.size()));
+}
+
+bool generate(const char* path) {
+    std::ofstream out{path, std::ios::binary};
+    const std::basic_string<uint8_t> exp{0x01, 0x00, 0x01};
+    for (uint64_t i{0}; i < 1000; ++i) {
+        append_record(out, 0x01, SILKPRE_EVMC_BERLIN, ecrec_input());
+        append_record(out, 0x02, SILKPRE_EVMC_BERLIN, random_bytes(i % 300, i));
+        append_record(out, 0x04, SILKPRE_EVMC_BERLIN, random_bytes(i % 1000, i));
+        if (i % 4 == 0) {
+            const size_t len{size_t{32} << (i % 3)};
+            append_record(out, 0x05, SILKPRE_EVMC_BERLIN, expmod_input(len, exp, len, i % 2));
+            append_record(out, 0x06, SILKPRE_EVMC_BERLIN, bn_add_input());
+            append_record(out, 0x07, SILKPRE_EVMC_BERLIN, bn_mul_variable_base_input());
+            append_record(out, 0x09, SILKPRE_EVMC_BERLIN, blake2_f_input(12));
+        }
+        if (i % 50 == 0) {
+            append_record(out, 0x08, SILKPRE_EVMC_BERLIN, snarkv_input(2));
+        }
+    }
+    return out.good();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::strcmp(argv[1], "--generate") == 0) {
+        return generate(argv[2]) ? 0 : 1;
+    }
+
+    const char* path{nullptr};
+    size_t num_threads{std::max(1u, std::thread::hardware_concurrency())};
+    for (int i{1}; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0) {
+            num_threads = std::max(1, std::atoi(argv[i] + 10));
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s <corpus> [--threads=N]\n       %s --generate <corpus>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    const MappedFile file{path};
+    if (!file.ok()) {
+        std::fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    std::vector<Record> records;
+    if (!parse(file, records)) {
+        std::fprintf(stderr, "Truncated record in %s\n", path);
+        return 1;
+    }
+
+    Totals single;
+    const double single_seconds{replay(records, 1, single)};
+    report("single-threaded", 1, single_seconds, single);
+
+    Totals multi;
+    const double multi_seconds{replay(records, num_threads, multi)};
+    report("multi-threaded", num_threads, multi_seconds, multi);
+
+    for (size_t i{0}; i < SILKPRE_NUMBER_OF_CONTRACTS; ++i) {
+        if (single[i].checksum != multi[i].checksum) {
+            std::fprintf(stderr, "Checksum mismatch for %s\n", silkpre_contract_descriptor(i)->name);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -43,3 +43,52 @@ TEST_CASE("SHA256 sample") {
     silkpre_sha256(hash, input.data(), input.length(), /*use_cpu_extensions=*/true);
     CHECK(to_hex(hash, 32) == "7303caef875be8c39b2c2f1905ea24adcc024bef6830a965fe05370f3170dc52");
 }
+
+TEST_CASE("SHA256 of 64 bytes") {
+    std::basic_string<uint8_t> input(64, 0);
+    uint8_t hash[32];
+    silkpre_sha256_64(hash, input.data(), /*use_cpu_extensions=*/false);
+    CHECK(to_hex(hash, 32) == "f5a5fd42d16a20302798ef6ed309979b43003d2320d9f0e8ea9831a92759fb4b");
+
+    input = from_hex(
+        "1234567812345678123456781234567812345678123456781234567812345678"
+        "9abcdef09abcdef09abcdef09abcdef09abcdef09abcdef09abcdef09abcdef0");
+    silkpre_sha256_64(hash, input.data(), /*use_cpu_extensions=*/true);
+    CHECK(to_hex(hash, 32) == "a36044c2937ac3bbac1eeb9ebc1793c8e31954d6da32892f6ca6bcfdc4e3c214");
+    silkpre_sha256(hash, input.data(), input.length(), /*use_cpu_extensions=*/false);
+    CHECK(to_hex(hash, 32) == "a36044c2937ac3bbac1eeb9ebc1793c8e31954d6da32892f6ca6bcfdc4e3c214");
+}
+
+TEST_CASE("SHA256 Merkle root") {
+    uint8_t root[32];
+    REQUIRE(silkpre_sha256_merkleize(root, nullptr, 0, /*use_cpu_extensions=*/true));
+    CHECK(to_hex(root, 32) == "0000000000000000000000000000000000000000000000000000000000000000");
+
+    // Zero hashes of the deposit contract
+    const std::basic_string<uint8_t> zeroes(32 * 5, 0);
+    REQUIRE(silkpre_sha256_merkleize(root, zeroes.data(), 4, /*use_cpu_extensions=*/true));
+    CHECK(to_hex(root, 32) == "db56114e00fdd4c1f85c892bf35ac9a89289aaecb1ebd0a96cde606a748b5d71");
+    // padded to 8 leaves
+    REQUIRE(silkpre_sha256_merkleize(root, zeroes.data(), 5, /*use_cpu_extensions=*/false));
+    CHECK(to_hex(root, 32) == "c78009fdf07fc56a11f122370658a353aaa542ed63e44c4bc15ff4cd105ab33c");
+
+    std::basic_string<uint8_t> leaves;
+    for (uint8_t i{1}; i <= 3; ++i) {
+        leaves += std::basic_string<uint8_t>(32, i);
+    }
+    REQUIRE(silkpre_sha256_merkleize(root, leaves.data(), 1, /*use_cpu_extensions=*/true));
+    CHECK(to_hex(root, 32) == to_hex(leaves.data(), 32));
+
+    // H(H(1 | 2) | H(3 | 0))
+    uint8_t nodes[64];
+    silkpre_sha256_64(nodes, leaves.data(), /*use_cpu_extensions=*/false);
+    std::basic_string<uint8_t> pair{leaves.substr(64)};
+    pair += std::basic_string<uint8_t>(32, 0);
+    silkpre_sha256_64(nodes + 32, pair.data(), /*use_cpu_extensions=*/false);
+    uint8_t expected[32];
+    silkpre_sha256_64(expected, nodes, /*use_cpu_extensions=*/false);
+    for (bool use_cpu_extensions : {false, true}) {
+        REQUIRE(silkpre_sha256_merkleize(root, leaves.data(), 3, use_cpu_extensions));
+        CHECK(to_hex(root, 32) == to_hex(expected, 32));
+    }
+}
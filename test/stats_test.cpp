@@ -0,0 +1,46 @@
+/*
+   Copyright 2022 The Silkpre Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdlib>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkpre/stats.h>
+
+#include "hex.hpp"
+
+TEST_CASE("Stats snapshot") {
+    SilkpreStats before{};
+    const bool enabled{silkpre_stats_snapshot(&before)};
+
+    const SilkpreContract& id{kSilkpreContracts[3]};
+    const std::basic_string<uint8_t> in(100, 0xab);
+    const uint64_t gas{id.gas(in.data(), in.length(), SILKPRE_EVMC_BERLIN)};
+    SilkpreOutput out{id.run(in.data(), in.length())};
+    std::free(out.data);
+
+    SilkpreStats after{};
+    CHECK(silkpre_stats_snapshot(&after) == enabled);
+    const SilkpreContractStats& s{after.contracts[3]};
+    if (!enabled) {
+        CHECK(s.calls == 0);
+        return;
+    }
+    CHECK(s.calls == before.contracts[3].calls + 1);
+    CHECK(s.total_gas == before.contracts[3].total_gas + gas);
+    CHECK(s.input_size[7] == before.contracts[3].input_size[7] + 1);  // 64 <= 100 < 128
+}